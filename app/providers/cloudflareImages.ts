@@ -0,0 +1,19 @@
+import { joinURL, withQuery } from "ufo";
+import { defineProvider } from "@nuxt/image/runtime";
+
+/**
+ * @nuxt/image provider for the Worker's /_img route, which resizes with the
+ * Cloudflare IMAGES binding (server/routes/_img/[...path].get.ts).
+ */
+export default defineProvider<{ baseURL?: string }>({
+  getImage(src, { modifiers, baseURL = "/_img" }) {
+    const { width, quality, format } = modifiers;
+    return {
+      url: withQuery(joinURL(baseURL, src), {
+        w: width,
+        q: quality,
+        f: format,
+      }),
+    };
+  },
+});
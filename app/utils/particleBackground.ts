@@ -0,0 +1,402 @@
+import {
+  BufferAttribute,
+  BufferGeometry,
+  Color,
+  FogExp2,
+  NormalBlending,
+  PerspectiveCamera,
+  Points,
+  Scene,
+  ShaderMaterial,
+  UniformsLib,
+  UniformsUtils,
+  Vector2,
+  WebGLRenderer,
+} from "three";
+import {
+  particleFragmentShader,
+  particleVertexShader,
+} from "./particleShaders";
+import {
+  FRAME_TIME_BUCKETS,
+  frameTimeBucket,
+  type WebGLMetrics,
+} from "#shared/utils/webglMetrics";
+import { getParticleField } from "./particleField";
+import { QualityController, type QualityLevel } from "./qualityController";
+
+/**
+ * The WebGL particle background, independent of the DOM so the same code
+ * can drive a regular canvas on the main thread or an OffscreenCanvas in a
+ * worker (see app/workers/particleBackground.worker.ts).
+ *
+ * The host decides *whether* to animate (visibility, reduced motion, ...)
+ * and forwards size and theme changes; this class owns the render loop,
+ * adaptive quality and all Three.js state.
+ */
+
+export interface BackgroundSize {
+  width: number;
+  height: number;
+  devicePixelRatio: number;
+}
+
+export interface BackgroundOptions {
+  size: BackgroundSize;
+  isDark: boolean;
+  // Render into this canvas; when omitted the renderer creates its own and
+  // may replace it (antialiasing can only change with a new context)
+  canvas?: HTMLCanvasElement | OffscreenCanvas;
+  onCanvasReplaced?: (canvas: HTMLCanvasElement) => void;
+}
+
+// Messages from the host page to the background worker
+export type BackgroundWorkerMessage =
+  | {
+      type: "init";
+      canvas: OffscreenCanvas;
+      size: BackgroundSize;
+      isDark: boolean;
+    }
+  | { type: "resize"; size: BackgroundSize }
+  | { type: "theme"; isDark: boolean }
+  | { type: "animate"; enabled: boolean }
+  | { type: "metrics"; id: number }
+  | { type: "dispose" };
+
+// Messages from the background worker to the host page
+export type BackgroundWorkerEvent =
+  | { type: "ready" }
+  // Answers every request with its id; null before the renderer exists
+  | { type: "metrics"; id: number; metrics: BackgroundMetrics | null }
+  | { type: "error"; message: string };
+
+// What the engine can report; the host adds how it was collected
+export type BackgroundMetrics = Omit<WebGLMetrics, "mode">;
+
+// Upper bound; the quality controller draws a share of these via setDrawRange
+const particleCount = 3000;
+
+// Catppuccin colors
+const colors = {
+  macchiato: {
+    base: 0x24273a,
+    surface0: 0x363a4f,
+    mauve: 0xc6a0f6,
+    lavender: 0xb7bdf8,
+    sapphire: 0x7dc4e4,
+    teal: 0x8bd5ca,
+  },
+  latte: {
+    base: 0xeff1f5,
+    surface0: 0xccd0da,
+    mauve: 0x8839ef,
+    lavender: 0x7287fd,
+    sapphire: 0x209fb5,
+    teal: 0x179299,
+  },
+};
+
+// Particle palette slots, in the order stored in the `paletteIndex` attribute
+const paletteKeys = ["mauve", "lavender", "sapphire", "teal"] as const;
+
+// Both palettes are uploaded once; the shader crossfades between them
+const darkPalette = paletteKeys.map(
+  (key) => new Color(colors.macchiato[key]),
+);
+const lightPalette = paletteKeys.map((key) => new Color(colors.latte[key]));
+const darkBase = new Color(colors.macchiato.base);
+const lightBase = new Color(colors.latte.base);
+
+const THEME_TRANSITION_MS = 400;
+
+// Soft edge added around each sprite, in CSS pixels (what blur-sm gave)
+const SPRITE_BLUR_PX = 4;
+
+// Upper bound on drawing buffer pixels, whatever the screen and quality
+// level; large high-DPI displays get a slightly upscaled canvas instead
+const MAX_DRAWING_BUFFER_PIXELS = 2560 * 1600;
+
+// Dedicated workers have requestAnimationFrame in browsers that support
+// OffscreenCanvas WebGL, but fall back to a timer just in case
+const requestFrame: (callback: FrameRequestCallback) => number =
+  typeof requestAnimationFrame === "function"
+    ? (callback) => requestAnimationFrame(callback)
+    : (callback) =>
+        setTimeout(() => callback(performance.now()), 16) as unknown as number;
+const cancelFrame: (handle: number) => void =
+  typeof cancelAnimationFrame === "function"
+    ? (handle) => cancelAnimationFrame(handle)
+    : (handle) => clearTimeout(handle);
+
+export class ParticleBackground {
+  private readonly scene = new Scene();
+  private readonly background = new Color();
+  private readonly fog = new FogExp2(0, 0.04);
+  private readonly rendererSize = new Vector2();
+  private readonly camera: PerspectiveCamera;
+  private renderer!: WebGLRenderer;
+  private readonly particles: Points;
+  private readonly material: ShaderMaterial;
+  private readonly quality: QualityController;
+  private readonly canvas?: HTMLCanvasElement | OffscreenCanvas;
+  private readonly onCanvasReplaced?: (canvas: HTMLCanvasElement) => void;
+
+  private size: BackgroundSize;
+  private themeMix: number; // 0 = dark, 1 = light
+  private themeTarget: number;
+  private frameId = 0;
+  private lastFrameTime = 0;
+  private elapsed = 0; // Animation clock in ms; only advances while animating
+  private animating = false;
+  private readonly frameTimes = new Uint32Array(FRAME_TIME_BUCKETS.length + 1);
+  private frameTimeTotal = 0;
+
+  constructor(options: BackgroundOptions) {
+    this.size = options.size;
+    this.themeMix = this.themeTarget = options.isDark ? 0 : 1;
+    this.canvas = options.canvas;
+    this.onCanvasReplaced = options.onCanvasReplaced;
+
+    // Scene with Catppuccin background color; both are updated in place
+    this.scene.background = this.background;
+    this.scene.fog = this.fog;
+
+    // Camera
+    this.camera = new PerspectiveCamera(
+      60,
+      this.size.width / this.size.height,
+      0.1,
+      1000,
+    );
+    this.camera.position.z = 5;
+
+    this.quality = new QualityController((level) => this.applyQuality(level));
+
+    // Renderer
+    this.createRenderer(this.quality.current);
+
+    // Create particles
+    this.material = this.createMaterial();
+    this.particles = new Points(this.createGeometry(), this.material);
+    this.scene.add(this.particles);
+    this.applyQuality(this.quality.current);
+  }
+
+  /** The renderer's canvas, when it created its own. */
+  get domElement(): HTMLCanvasElement | undefined {
+    return this.canvas ? undefined : this.renderer.domElement;
+  }
+
+  setAnimating(enabled: boolean): void {
+    if (enabled && !this.animating) {
+      this.animating = true;
+      this.lastFrameTime = 0;
+      cancelFrame(this.frameId);
+      this.frameId = requestFrame(this.animate);
+    } else if (!enabled && this.animating) {
+      this.animating = false;
+      cancelFrame(this.frameId);
+      // Finish any theme crossfade in the static frame
+      this.themeMix = this.themeTarget;
+    }
+
+    this.requestRender();
+  }
+
+  resize(size: BackgroundSize): void {
+    this.size = size;
+    this.camera.aspect = size.width / size.height;
+    this.camera.updateProjectionMatrix();
+    this.applyQuality(this.quality.current);
+  }
+
+  /**
+   * Crossfades to the other palette over THEME_TRANSITION_MS while animating.
+   * When the loop is paused (including reduced motion) it switches at once.
+   */
+  setTheme(isDark: boolean): void {
+    this.themeTarget = isDark ? 0 : 1;
+    if (!this.animating) {
+      this.themeMix = this.themeTarget;
+    }
+    this.requestRender();
+  }
+
+  /** Frame-time histogram since creation, plus current renderer state. */
+  getMetrics(): BackgroundMetrics {
+    const { calls, points } = this.renderer.info.render;
+    const { antialias = false } =
+      this.renderer.getContext().getContextAttributes() ?? {};
+    return {
+      frames: this.frameTimes.reduce((sum, count) => sum + count, 0),
+      frameTimeTotalMs: this.frameTimeTotal,
+      frameTimeHistogram: Array.from(this.frameTimes),
+      pixelRatio: this.renderer.getPixelRatio(),
+      particleCount: this.particles.geometry.drawRange.count,
+      qualityLevel: this.quality.currentIndex,
+      antialias,
+      drawCalls: calls,
+      points,
+    };
+  }
+
+  dispose(): void {
+    this.animating = false;
+    cancelFrame(this.frameId);
+    this.particles.geometry.dispose();
+    this.material.dispose();
+    this.renderer.dispose();
+  }
+
+  private createGeometry() {
+    const { positions, paletteIndices, sizes } = getParticleField(
+      particleCount,
+      paletteKeys.length,
+    );
+    const geometry = new BufferGeometry();
+
+    geometry.setAttribute("position", new BufferAttribute(positions, 3));
+    geometry.setAttribute(
+      "paletteIndex",
+      new BufferAttribute(paletteIndices, 1),
+    );
+    geometry.setAttribute("size", new BufferAttribute(sizes, 1));
+
+    return geometry;
+  }
+
+  private createMaterial() {
+    return new ShaderMaterial({
+      uniforms: UniformsUtils.merge([
+        UniformsLib.fog,
+        {
+          uTime: { value: 0 },
+          // Scales the per-particle `size` attribute (1-4) to world units
+          uSize: { value: 0.048 },
+          uScale: { value: this.getPointScale() },
+          uBlur: { value: this.getBlurPixels() },
+          uPaletteDark: { value: darkPalette },
+          uPaletteLight: { value: lightPalette },
+          uThemeMix: { value: this.themeMix },
+        },
+      ]),
+      vertexShader: particleVertexShader,
+      fragmentShader: particleFragmentShader,
+      transparent: true,
+      depthWrite: false,
+      blending: NormalBlending,
+      fog: true,
+    });
+  }
+
+  // Half the drawing buffer height, as PointsMaterial uses for size attenuation
+  private getPointScale() {
+    return this.size.height * this.renderer.getPixelRatio() * 0.5;
+  }
+
+  private getBlurPixels() {
+    return SPRITE_BLUR_PX * this.renderer.getPixelRatio();
+  }
+
+  private createRenderer(level: QualityLevel) {
+    this.renderer = new WebGLRenderer({
+      canvas: this.canvas,
+      antialias: level.antialias,
+      alpha: true,
+    });
+    this.setRendererSize(level);
+  }
+
+  // CSS sizes the canvas; only the drawing buffer is set here, which is also
+  // all an OffscreenCanvas supports. Skips reallocation when nothing changed.
+  private setRendererSize(level: QualityLevel) {
+    const { width, height, devicePixelRatio } = this.size;
+    const maxPixelRatio = Math.sqrt(
+      MAX_DRAWING_BUFFER_PIXELS / Math.max(width * height, 1),
+    );
+    const pixelRatio = Math.min(
+      devicePixelRatio,
+      level.pixelRatio,
+      maxPixelRatio,
+    );
+
+    const current = this.renderer.getSize(this.rendererSize);
+    if (
+      current.width === width &&
+      current.height === height &&
+      this.renderer.getPixelRatio() === pixelRatio
+    ) {
+      return;
+    }
+    this.renderer.setPixelRatio(pixelRatio);
+    this.renderer.setSize(width, height, false);
+  }
+
+  private applyQuality(level: QualityLevel) {
+    if (!this.particles) return;
+
+    // Antialiasing is fixed per WebGL context, so toggling it means a new
+    // renderer. A canvas handed to us can't get a new context, so it keeps
+    // its initial antialiasing and only the other settings change.
+    const { antialias } =
+      this.renderer.getContext().getContextAttributes() ?? {};
+    if (!this.canvas && antialias !== level.antialias) {
+      this.renderer.dispose();
+      this.createRenderer(level);
+      this.onCanvasReplaced?.(this.renderer.domElement);
+    } else {
+      this.setRendererSize(level);
+    }
+
+    this.particles.geometry.setDrawRange(
+      0,
+      Math.floor(particleCount * level.particleFraction),
+    );
+    this.material.uniforms.uScale!.value = this.getPointScale();
+    this.material.uniforms.uBlur!.value = this.getBlurPixels();
+    this.requestRender();
+  }
+
+  private renderFrame = () => {
+    // All motion is computed in the vertex shader from this one uniform
+    this.material.uniforms.uTime!.value = this.elapsed * 0.001;
+    this.material.uniforms.uThemeMix!.value = this.themeMix;
+    this.background.lerpColors(darkBase, lightBase, this.themeMix);
+    this.fog.color.copy(this.background);
+    this.renderer.render(this.scene, this.camera);
+  };
+
+  private animate = (now: number) => {
+    if (!this.animating) return;
+    this.frameId = requestFrame(this.animate);
+
+    if (this.lastFrameTime) {
+      const delta = now - this.lastFrameTime;
+      this.quality.sample(delta);
+      this.frameTimes[frameTimeBucket(delta)]!++;
+      this.frameTimeTotal += delta;
+      this.elapsed += delta;
+      this.stepThemeTransition(delta);
+    }
+    this.lastFrameTime = now;
+
+    this.renderFrame();
+  };
+
+  private stepThemeTransition(delta: number) {
+    if (this.themeMix === this.themeTarget) return;
+    const step = delta / THEME_TRANSITION_MS;
+    this.themeMix =
+      this.themeTarget > this.themeMix
+        ? Math.min(this.themeMix + step, this.themeTarget)
+        : Math.max(this.themeMix - step, this.themeTarget);
+  }
+
+  // Draw a single static frame when the loop isn't running
+  private requestRender() {
+    if (this.animating) return;
+    cancelFrame(this.frameId);
+    this.frameId = requestFrame(this.renderFrame);
+  }
+}
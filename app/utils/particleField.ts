@@ -0,0 +1,64 @@
+/**
+ * The background's particle layout, generated from a fixed seed so the
+ * field looks the same on every visit.
+ *
+ * The buffers are built once per JS context and reused by every
+ * ParticleBackground created afterwards (remounts, HMR, future views). With
+ * OffscreenCanvas that context is the background worker, which
+ * WebGLBackground.vue keeps alive across mounts for this reason.
+ * Geometries wrap them without copying and never write to them, so
+ * disposing a geometry leaves the cached field intact.
+ */
+
+export interface ParticleField {
+  count: number;
+  positions: Float32Array; // xyz per particle
+  paletteIndices: Uint8Array; // Palette slot per particle
+  sizes: Float32Array; // 1-4, scaled by the material's uSize
+}
+
+const PARTICLE_FIELD_SEED = 0x616d6269; // "ambi"
+
+let cached: ParticleField | undefined;
+let cachedPaletteSize = 0;
+
+// mulberry32: tiny, fast and plenty for scattering points
+function mulberry32(seed: number) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+export function getParticleField(
+  count: number,
+  paletteSize: number,
+): ParticleField {
+  if (cached?.count === count && cachedPaletteSize === paletteSize) {
+    return cached;
+  }
+
+  const random = mulberry32(PARTICLE_FIELD_SEED);
+  const positions = new Float32Array(count * 3);
+  const paletteIndices = new Uint8Array(count);
+  const sizes = new Float32Array(count);
+
+  for (let i = 0; i < count; i++) {
+    const i3 = i * 3;
+    positions[i3] = (random() - 0.5) * 20;
+    positions[i3 + 1] = (random() - 0.5) * 20;
+    positions[i3 + 2] = (random() - 0.5) * 10 - 5;
+
+    paletteIndices[i] = Math.floor(random() * paletteSize);
+
+    sizes[i] = random() * 3 + 1;
+  }
+
+  cached = { count, positions, paletteIndices, sizes };
+  cachedPaletteSize = paletteSize;
+  return cached;
+}
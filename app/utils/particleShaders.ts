@@ -0,0 +1,89 @@
+/**
+ * GLSL for the background particle field.
+ *
+ * All motion runs on the GPU: the vertex shader derives drift, the slow
+ * field rotation, per-particle size and twinkle from `uTime` and the static
+ * attributes, so the CPU only updates one uniform per frame.
+ *
+ * Colors come from a per-particle palette slot looked up in both theme
+ * palettes and mixed by `uThemeMix`, so a theme switch is a uniform
+ * crossfade rather than a color buffer rewrite.
+ *
+ * Softness is part of the sprite: each point is grown by `uBlur` device
+ * pixels and its edge fades across that margin, which looks like the old
+ * full-screen CSS blur without a compositor filter pass.
+ */
+
+export const particleVertexShader = /* glsl */ `
+uniform float uTime;
+uniform float uSize;
+uniform float uScale;
+uniform float uBlur;
+uniform vec3 uPaletteDark[4];
+uniform vec3 uPaletteLight[4];
+uniform float uThemeMix;
+
+attribute float size;
+attribute float paletteIndex;
+
+varying vec3 vColor;
+varying float vAlpha;
+varying float vCore;
+
+#include <fog_pars_vertex>
+
+void main() {
+  // Stable per-particle phase derived from its rest position
+  float phase = fract(sin(dot(position, vec3(12.9898, 78.233, 37.719))) * 43758.5453) * 6.2831853;
+
+  // Gentle drift around the rest position
+  vec3 p = position;
+  p.x += sin(uTime * 0.21 + phase) * 0.12;
+  p.y += cos(uTime * 0.17 + phase * 1.3) * 0.12;
+
+  // Slow rotation of the whole field
+  float ry = uTime * 0.03;
+  float rx = sin(uTime * 0.05) * 0.05;
+  mat3 rotY = mat3(cos(ry), 0.0, -sin(ry), 0.0, 1.0, 0.0, sin(ry), 0.0, cos(ry));
+  mat3 rotX = mat3(1.0, 0.0, 0.0, 0.0, cos(rx), sin(rx), 0.0, -sin(rx), cos(rx));
+  p = rotY * rotX * p;
+
+  vec4 mvPosition = modelViewMatrix * vec4(p, 1.0);
+  gl_Position = projectionMatrix * mvPosition;
+
+  // Perspective-attenuated size, matching PointsMaterial's sizeAttenuation,
+  // plus the blur margin on every side
+  float core = uSize * size * (uScale / -mvPosition.z);
+  gl_PointSize = core + 2.0 * uBlur;
+  vCore = core / gl_PointSize;
+
+  int slot = int(paletteIndex + 0.5);
+  vColor = mix(uPaletteDark[slot], uPaletteLight[slot], uThemeMix);
+  vAlpha = 0.6 * (0.7 + 0.3 * sin(uTime * (0.6 + fract(phase) * 1.4) + phase));
+
+  #include <fog_vertex>
+}
+`;
+
+export const particleFragmentShader = /* glsl */ `
+varying vec3 vColor;
+varying float vAlpha;
+varying float vCore; // Share of the sprite covered by the unblurred disc
+
+#include <fog_pars_fragment>
+
+void main() {
+  // Round sprite whose edge fades out across the blur margin. Small points
+  // spread over a larger area, so they also dim, as a real blur would.
+  float d = length(gl_PointCoord - 0.5);
+  if (d > 0.5) discard;
+  float radius = 0.5 * vCore;
+  float falloff = 1.0 - smoothstep(radius - (0.5 - radius), 0.5, d);
+  float alpha = vAlpha * falloff * falloff * (0.4 + 0.6 * vCore);
+
+  gl_FragColor = vec4(vColor, alpha);
+
+  #include <colorspace_fragment>
+  #include <fog_fragment>
+}
+`;
@@ -0,0 +1,113 @@
+/**
+ * Adaptive quality for the WebGL background.
+ *
+ * Frame times are sampled from the render loop in fixed windows. Sustained
+ * misses against the frame budget step quality down one level; repeated
+ * windows with next to no misses step it back up.
+ *
+ * rAF deltas are locked to the display refresh, so spare time per frame
+ * never shows up in them and a clean window is the only headroom signal.
+ * Stepping up is therefore a probe: if the next window misses again, the
+ * number of clean windows needed before the next probe doubles, so a device
+ * sitting at its limit doesn't flip between two levels.
+ */
+
+export interface QualityLevel {
+  pixelRatio: number; // Upper bound, further capped by devicePixelRatio
+  particleFraction: number; // Share of particles drawn via setDrawRange
+  antialias: boolean; // Changing this requires a new WebGL context
+}
+
+// Ordered from best to cheapest
+export const QUALITY_LEVELS: QualityLevel[] = [
+  { pixelRatio: 2, particleFraction: 1, antialias: true },
+  { pixelRatio: 1.5, particleFraction: 1, antialias: true },
+  { pixelRatio: 1.25, particleFraction: 0.75, antialias: false },
+  { pixelRatio: 1, particleFraction: 0.5, antialias: false },
+  { pixelRatio: 0.75, particleFraction: 0.35, antialias: false },
+];
+
+const TARGET_FRAME_MS = 1000 / 60;
+const SAMPLE_WINDOW = 90; // Frames per evaluation (~1.5s at 60fps)
+const MISS_THRESHOLD_MS = TARGET_FRAME_MS * 1.25;
+const MAX_MISS_RATIO = 0.25; // Step down when more frames than this miss
+const HEADROOM_MISS_RATIO = 0.02; // At most this many misses counts as clean
+const HEADROOM_WINDOWS = 4; // Consecutive clean windows before stepping up
+const MAX_HEADROOM_WINDOWS = 32; // Cap for the backoff after failed probes
+const IGNORE_FRAME_MS = 250; // Longer gaps are tab switches or stalls, not load
+
+export class QualityController {
+  private level: number;
+  private frames = 0;
+  private misses = 0;
+  private headroomWindows = 0;
+  private requiredHeadroomWindows = HEADROOM_WINDOWS;
+  private probing = false;
+  private settling = true;
+
+  constructor(
+    private readonly onChange: (level: QualityLevel) => void,
+    initialLevel = 0,
+  ) {
+    this.level = Math.min(Math.max(initialLevel, 0), QUALITY_LEVELS.length - 1);
+  }
+
+  get current(): QualityLevel {
+    return QUALITY_LEVELS[this.level]!;
+  }
+
+  get currentIndex(): number {
+    return this.level;
+  }
+
+  sample(frameMs: number): void {
+    if (frameMs <= 0 || frameMs > IGNORE_FRAME_MS) return;
+
+    this.frames++;
+    if (frameMs > MISS_THRESHOLD_MS) this.misses++;
+
+    if (this.frames < SAMPLE_WINDOW) return;
+
+    const missRatio = this.misses / this.frames;
+    this.frames = 0;
+    this.misses = 0;
+
+    // Discard the first window after a change while the GPU settles
+    if (this.settling) {
+      this.settling = false;
+      return;
+    }
+
+    // Only the first window at a level reached by stepping up judges it
+    const probing = this.probing;
+    this.probing = false;
+
+    if (missRatio > MAX_MISS_RATIO) {
+      this.headroomWindows = 0;
+      if (probing) {
+        this.requiredHeadroomWindows = Math.min(
+          this.requiredHeadroomWindows * 2,
+          MAX_HEADROOM_WINDOWS,
+        );
+      }
+      this.setLevel(this.level + 1);
+    } else if (missRatio <= HEADROOM_MISS_RATIO) {
+      if (++this.headroomWindows >= this.requiredHeadroomWindows) {
+        this.headroomWindows = 0;
+        this.probing = this.setLevel(this.level - 1);
+      }
+    } else {
+      this.headroomWindows = 0;
+    }
+  }
+
+  private setLevel(level: number): boolean {
+    if (level < 0 || level >= QUALITY_LEVELS.length || level === this.level) {
+      return false;
+    }
+    this.level = level;
+    this.settling = true;
+    this.onChange(this.current);
+    return true;
+  }
+}
@@ -0,0 +1,82 @@
+import type {
+  WebGLMetrics,
+  WebGLMetricsMode,
+} from "#shared/utils/webglMetrics";
+import type { BackgroundMetrics } from "./particleBackground";
+
+/**
+ * Sends WebGL background metrics to /api/metrics with sendBeacon.
+ *
+ * `?bench=webgl` collects for BENCH_DURATION_MS, logs the result and sends
+ * it. Otherwise a RUM_SAMPLE_RATE share of visits sends one snapshot when
+ * the page is hidden. Snapshots are polled ahead of time because the
+ * renderer may live in a worker, and pagehide can't wait for a reply.
+ */
+
+export const RUM_SAMPLE_RATE = 0.01;
+const BENCH_DURATION_MS = 20_000;
+const POLL_MS = 5_000;
+
+type MetricsSource = () =>
+  | BackgroundMetrics
+  | Promise<BackgroundMetrics | undefined>
+  | undefined;
+
+export function getMetricsMode(): WebGLMetricsMode | undefined {
+  if (new URLSearchParams(location.search).get("bench") === "webgl") {
+    return "bench";
+  }
+  return Math.random() < RUM_SAMPLE_RATE ? "rum" : undefined;
+}
+
+function send(metrics: WebGLMetrics) {
+  const body = new Blob([JSON.stringify(metrics)], {
+    type: "application/json",
+  });
+  navigator.sendBeacon("/api/metrics", body);
+}
+
+/** Start reporting; returns a function that stops it. */
+export function startMetricsReporting(
+  mode: WebGLMetricsMode,
+  source: MetricsSource,
+): () => void {
+  let latest: BackgroundMetrics | undefined;
+  let sent = false;
+
+  const poll = async () => {
+    latest = (await source()) ?? latest;
+  };
+
+  const flush = () => {
+    if (sent || !latest || latest.frames === 0) return;
+    sent = true;
+    send({ mode, ...latest });
+  };
+
+  const onHidden = () => {
+    if (document.visibilityState === "hidden") flush();
+  };
+
+  const interval = setInterval(poll, POLL_MS);
+  let benchTimer: ReturnType<typeof setTimeout> | undefined;
+
+  if (mode === "bench") {
+    benchTimer = setTimeout(async () => {
+      await poll();
+      console.info("WebGL background metrics", latest);
+      flush();
+      clearInterval(interval);
+    }, BENCH_DURATION_MS);
+  } else {
+    document.addEventListener("visibilitychange", onHidden);
+    window.addEventListener("pagehide", flush);
+  }
+
+  return () => {
+    clearInterval(interval);
+    clearTimeout(benchTimer);
+    document.removeEventListener("visibilitychange", onHidden);
+    window.removeEventListener("pagehide", flush);
+  };
+}
@@ -0,0 +1,64 @@
+/// <reference lib="webworker" />
+import {
+  ParticleBackground,
+  type BackgroundWorkerEvent,
+  type BackgroundWorkerMessage,
+} from "../utils/particleBackground";
+
+/**
+ * Runs the particle background on an OffscreenCanvas transferred from
+ * WebGLBackground.vue, keeping scene setup and rendering off the main thread.
+ * The worker lives for the whole page: each mount sends `init` with a new
+ * canvas and `dispose` when it unmounts, and module state such as the
+ * particle field cache carries over between them.
+ */
+declare const self: DedicatedWorkerGlobalScope;
+
+let background: ParticleBackground | undefined;
+
+function post(message: BackgroundWorkerEvent) {
+  self.postMessage(message);
+}
+
+self.onmessage = (event: MessageEvent<BackgroundWorkerMessage>) => {
+  const message = event.data;
+
+  try {
+    switch (message.type) {
+      case "init":
+        background?.dispose();
+        background = new ParticleBackground({
+          canvas: message.canvas,
+          size: message.size,
+          isDark: message.isDark,
+        });
+        post({ type: "ready" });
+        break;
+      case "resize":
+        background?.resize(message.size);
+        break;
+      case "theme":
+        background?.setTheme(message.isDark);
+        break;
+      case "animate":
+        background?.setAnimating(message.enabled);
+        break;
+      case "metrics":
+        post({
+          type: "metrics",
+          id: message.id,
+          metrics: background?.getMetrics() ?? null,
+        });
+        break;
+      case "dispose":
+        background?.dispose();
+        background = undefined;
+        break;
+    }
+  } catch (error) {
+    post({
+      type: "error",
+      message: error instanceof Error ? error.message : String(error),
+    });
+  }
+};
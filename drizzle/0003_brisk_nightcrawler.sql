@@ -0,0 +1 @@
+CREATE INDEX `subscriptions_status_created_at_idx` ON `subscriptions` (`status`,`created_at`,`id`);
\ No newline at end of file
@@ -0,0 +1,25 @@
+CREATE TABLE `subscription_counts` (
+	`status` text PRIMARY KEY NOT NULL,
+	`count` integer DEFAULT 0 NOT NULL
+);
+--> statement-breakpoint
+INSERT INTO `subscription_counts` (`status`, `count`) VALUES
+	('active', (SELECT count(*) FROM `subscriptions` WHERE `status` = 'active')),
+	('unsubscribed', (SELECT count(*) FROM `subscriptions` WHERE `status` = 'unsubscribed'));
+--> statement-breakpoint
+CREATE TRIGGER `subscriptions_count_insert` AFTER INSERT ON `subscriptions`
+BEGIN
+	UPDATE `subscription_counts` SET `count` = `count` + 1 WHERE `status` = NEW.`status`;
+END;
+--> statement-breakpoint
+CREATE TRIGGER `subscriptions_count_update` AFTER UPDATE OF `status` ON `subscriptions`
+WHEN OLD.`status` <> NEW.`status`
+BEGIN
+	UPDATE `subscription_counts` SET `count` = `count` - 1 WHERE `status` = OLD.`status`;
+	UPDATE `subscription_counts` SET `count` = `count` + 1 WHERE `status` = NEW.`status`;
+END;
+--> statement-breakpoint
+CREATE TRIGGER `subscriptions_count_delete` AFTER DELETE ON `subscriptions`
+BEGIN
+	UPDATE `subscription_counts` SET `count` = `count` - 1 WHERE `status` = OLD.`status`;
+END;
\ No newline at end of file
@@ -0,0 +1,17 @@
+CREATE TABLE `subscription_events` (
+	`id` integer PRIMARY KEY AUTOINCREMENT NOT NULL,
+	`subscription_id` integer NOT NULL,
+	`type` text NOT NULL,
+	`ip_address` text,
+	`user_agent` text,
+	`created_at` integer NOT NULL,
+	FOREIGN KEY (`subscription_id`) REFERENCES `subscriptions`(`id`) ON UPDATE no action ON DELETE cascade
+);
+--> statement-breakpoint
+CREATE INDEX `subscription_events_subscription_created_at_idx` ON `subscription_events` (`subscription_id`,`created_at`);--> statement-breakpoint
+INSERT INTO `subscription_events` (`subscription_id`, `type`, `ip_address`, `user_agent`, `created_at`)
+	SELECT `id`, 'subscribe', `ip_address`, `user_agent`, `updated_at` FROM `subscriptions`
+	WHERE `ip_address` IS NOT NULL OR `user_agent` IS NOT NULL;
+--> statement-breakpoint
+ALTER TABLE `subscriptions` DROP COLUMN `ip_address`;--> statement-breakpoint
+ALTER TABLE `subscriptions` DROP COLUMN `user_agent`;
\ No newline at end of file
@@ -0,0 +1 @@
+CREATE INDEX `subscriptions_created_at_idx` ON `subscriptions` (`created_at`,`id`);
\ No newline at end of file
@@ -19,12 +19,19 @@ export default defineNuxtConfig({
   // Global CSS - Tailwind v4 is imported here
   css: ["./app/assets/css/tailwind.css"],
 
+  // Inter is downloaded at build time and self-hosted from /_fonts. Only
+  // the weights the page uses (light tagline, body, medium headings,
+  // DaisyUI's semibold buttons) and the latin subset are shipped; swap
+  // keeps text visible behind size-adjusted fallback metrics.
   fonts: {
     families: [
       {
         name: "Inter",
         provider: "google",
-        weights: [300, 400, 500, 600, 700],
+        weights: [300, 400, 500, 600],
+        styles: ["normal"],
+        subsets: ["latin"],
+        display: "swap",
       },
     ],
     defaults: {
@@ -33,6 +40,35 @@ export default defineNuxtConfig({
     },
   },
 
+  // The three icons the page uses (drawn after Phosphor's bold weight)
+  // live in app/assets/icons as a local collection and are rendered as
+  // inline SVG, so nothing is fetched from the Iconify API at runtime
+  icon: {
+    mode: "svg",
+    customCollections: [{ prefix: "ambio", dir: "./app/assets/icons" }],
+    serverBundle: "local",
+    clientBundle: {
+      icons: ["ambio:check-circle", "ambio:sun", "ambio:moon"],
+      scan: true,
+    },
+    fallbackToApi: false,
+  },
+
+  // Images are resized at the edge by the IMAGES binding; see
+  // app/providers/cloudflareImages.ts
+  image: {
+    provider: "cloudflareImages",
+    providers: {
+      cloudflareImages: {
+        name: "cloudflareImages",
+        provider: "~/providers/cloudflareImages.ts",
+        options: { baseURL: "/_img" },
+      },
+    },
+    quality: 80,
+    densities: [1, 2, 3],
+  },
+
   app: {
     head: {
       title: "Ambio",
@@ -49,6 +85,24 @@ export default defineNuxtConfig({
     },
   },
 
+  routeRules: {
+    // The landing page is static: emit it at build time so ASSETS serves it
+    // without running the Worker
+    "/": { prerender: true },
+    // Content-hashed build output; also written to the generated _headers so
+    // it applies when ASSETS serves the files directly
+    "/_nuxt/**": {
+      headers: { "cache-control": "public, max-age=31536000, immutable" },
+    },
+    // Resized images set their own cache headers and use the Cache API
+    "/_img/**": { cache: false },
+    // Anything else rendered on demand is cached and revalidated in the
+    // background instead of re-rendered per request
+    "/**": { swr: 600 },
+    // API responses are per-request and must never be cached
+    "/api/**": { cache: false, headers: { "cache-control": "no-store" } },
+  },
+
   nitro: {
     preset: "cloudflare_module",
     prerender: {
@@ -60,14 +114,10 @@ export default defineNuxtConfig({
       nodeCompat: true,
     },
   },
-  // Vite configuration with Tailwind CSS v4
+  // Vite configuration with Tailwind CSS v4. Three.js is only ever loaded
+  // lazily on the client (WebGLBackground), so it needs no SSR or
+  // pre-bundling special cases and tree-shakes to the named imports used.
   vite: {
     plugins: [tailwindcss()],
-    optimizeDeps: {
-      include: ["three"],
-    },
-    ssr: {
-      noExternal: ["three"],
-    },
   },
 });
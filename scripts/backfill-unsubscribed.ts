@@ -0,0 +1,107 @@
+/**
+ * Backfill the KV unsubscribed set from D1.
+ *
+ * The queue ingestion mode (SUBSCRIPTION_INGEST_MODE = "queue") rejects
+ * signups by checking KV markers instead of reading D1, and markers are only
+ * written by unsubscribes and ingestion from then on. Run this once before
+ * switching a database with existing `unsubscribed` rows to queue mode, so
+ * those addresses are rejected too. Writing a marker that already exists is
+ * harmless, so the script can be re-run at any time.
+ *
+ *   bun run kv:backfill:local
+ *   bun run kv:backfill:remote
+ */
+import { mkdtemp, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { parseArgs } from "node:util";
+import { UNSUBSCRIBED_KEY_PREFIX } from "../server/utils/unsubscribed";
+
+const DATABASE = "ambio-systems";
+const KV_BINDING = "RATE_LIMIT_KV";
+
+// Rows read per D1 query, and markers per `kv bulk put` file (KV maximum)
+const PAGE_SIZE = 10_000;
+
+const { values: options } = parseArgs({
+  args: Bun.argv.slice(2),
+  options: {
+    remote: { type: "boolean", default: false },
+  },
+});
+
+const target = options.remote ? "--remote" : "--local";
+
+async function wrangler(args: string[]): Promise<string> {
+  const proc = Bun.spawn(["bun", "run", "wrangler", ...args], {
+    stdout: "pipe",
+    stderr: "inherit",
+  });
+  const [stdout, code] = await Promise.all([
+    new Response(proc.stdout).text(),
+    proc.exited,
+  ]);
+  if (code !== 0) {
+    throw new Error(`wrangler ${args.join(" ")} exited with ${code}`);
+  }
+  return stdout;
+}
+
+// Keyset-paginated on the primary key, so no page rescans earlier rows
+async function readUnsubscribed(afterId: number) {
+  const output = await wrangler([
+    "d1",
+    "execute",
+    DATABASE,
+    target,
+    "--json",
+    `--command=SELECT id, email FROM subscriptions WHERE status = 'unsubscribed' AND id > ${afterId} ORDER BY id LIMIT ${PAGE_SIZE}`,
+  ]);
+  const [result] = JSON.parse(output) as {
+    results: { id: number; email: string }[];
+  }[];
+  return result?.results ?? [];
+}
+
+async function main() {
+  const dir = await mkdtemp(join(tmpdir(), "ambio-backfill-"));
+  try {
+    let afterId = 0;
+    let total = 0;
+
+    for (;;) {
+      const rows = await readUnsubscribed(afterId);
+      if (rows.length === 0) break;
+
+      const file = join(dir, `markers-${afterId}.json`);
+      await Bun.write(
+        file,
+        JSON.stringify(
+          rows.map((row) => ({
+            key: `${UNSUBSCRIBED_KEY_PREFIX}${row.email}`,
+            value: "1",
+          })),
+        ),
+      );
+      await wrangler([
+        "kv",
+        "bulk",
+        "put",
+        file,
+        `--binding=${KV_BINDING}`,
+        target,
+      ]);
+
+      total += rows.length;
+      afterId = rows[rows.length - 1]!.id;
+      console.log(`Marked ${total} unsubscribed emails`);
+      if (rows.length < PAGE_SIZE) break;
+    }
+
+    console.log(`Done: ${total} markers written (${target.slice(2)})`);
+  } finally {
+    await rm(dir, { recursive: true, force: true });
+  }
+}
+
+await main();
@@ -0,0 +1,444 @@
+/**
+ * Load test for the API against local D1 and KV.
+ *
+ * Applies local migrations, seeds `subscriptions` with a deterministic
+ * data set, starts `wrangler dev` on the built Worker and replays a
+ * weighted traffic mix, then reports throughput and latency percentiles
+ * per scenario.
+ *
+ *   bun run bench                               # build, then default mix
+ *   bun run bench:run --mix=signup --duration=60
+ *   bun run bench:run --mix="duplicate=50,page-cursor=50" --concurrency=32
+ *   bun run bench:run --admin-key=local-bench-key -- --inspector-port=0
+ *
+ * Arguments after `--` are passed to `wrangler dev`. Admin scenarios need
+ * --admin-key (or BENCH_ADMIN_KEY); the key is written to the local
+ * Secrets Store before the server starts. Without it they are dropped
+ * from the mix.
+ */
+import { mkdtemp, rm } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { parseArgs } from "node:util";
+
+const DATABASE = "ambio-systems";
+const SECRET_STORE_ID = "c38e38cf995f4db08a71c9b616169d33";
+const SECRET_NAME = "admin_api_key";
+
+// Seeded rows use a reserved domain so they never collide with real data
+const SEED_DOMAIN = "seed.bench.example";
+const SIGNUP_DOMAIN = "new.bench.example";
+const SEED_ROWS_PER_STATEMENT = 500;
+const UNSUBSCRIBED_EVERY = 10; // Every 10th seeded row is unsubscribed
+
+// One fixed client IP so the rate limiter is exercised on purpose
+const RATE_LIMITED_IP = "203.0.113.7";
+
+const MIXES: Record<string, Record<string, number>> = {
+  default: {
+    signup: 30,
+    duplicate: 20,
+    unsubscribed: 10,
+    ratelimited: 10,
+    unsubscribe: 10,
+    "page-cursor": 15,
+    "page-offset": 5,
+  },
+  signup: { signup: 70, duplicate: 30 },
+  abuse: { ratelimited: 60, unsubscribed: 40 },
+  admin: { "page-cursor": 70, "page-offset": 30 },
+};
+
+const ADMIN_SCENARIOS = new Set(["page-cursor", "page-offset"]);
+
+const { values: options, positionals: wranglerArgs } = parseArgs({
+  args: Bun.argv.slice(2),
+  allowPositionals: true,
+  options: {
+    mix: { type: "string", default: "default" },
+    duration: { type: "string", default: "30" }, // Seconds
+    concurrency: { type: "string", default: "16" },
+    "seed-rows": { type: "string", default: "100000" },
+    "no-seed": { type: "boolean", default: false },
+    "page-size": { type: "string", default: "100" },
+    "page-depth": { type: "string", default: "50" }, // Cursor pages per walk
+    port: { type: "string", default: "8787" },
+    "admin-key": { type: "string" },
+    seed: { type: "string", default: "1" }, // PRNG seed for the traffic
+    json: { type: "boolean", default: false },
+  },
+});
+
+const durationMs = Number(options.duration) * 1000;
+const concurrency = Number(options.concurrency);
+const seedRows = Number(options["seed-rows"]);
+const pageSize = Number(options["page-size"]);
+const pageDepth = Number(options["page-depth"]);
+const baseUrl = `http://127.0.0.1:${options.port}`;
+const adminKey = options["admin-key"] ?? process.env.BENCH_ADMIN_KEY;
+
+// --- Helpers -----------------------------------------------------------------
+
+// mulberry32, so a given --seed replays the same request sequence
+function createRandom(seed: number) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+const random = createRandom(Number(options.seed));
+const randomInt = (max: number) => Math.floor(random() * max);
+
+async function wrangler(args: string[]) {
+  const proc = Bun.spawn(["bun", "run", "wrangler", ...args], {
+    stdout: "inherit",
+    stderr: "inherit",
+  });
+  const code = await proc.exited;
+  if (code !== 0) {
+    throw new Error(`wrangler ${args.join(" ")} exited with ${code}`);
+  }
+}
+
+function parseMix(spec: string): [string, number][] {
+  const preset = MIXES[spec];
+  const entries: [string, number][] = preset
+    ? Object.entries(preset)
+    : spec.split(",").map((part) => {
+        const [name = "", weight = "1"] = part.split("=");
+        return [name.trim(), Number(weight)];
+      });
+
+  for (const [name, weight] of entries) {
+    if (!(name in scenarios) || !(weight > 0)) {
+      throw new Error(`Invalid mix entry "${name}=${weight}"`);
+    }
+  }
+  if (adminKey) return entries;
+
+  const kept = entries.filter(([name]) => !ADMIN_SCENARIOS.has(name));
+  if (kept.length < entries.length) {
+    console.warn("No --admin-key given, skipping admin scenarios");
+  }
+  if (kept.length === 0) throw new Error("Nothing left in the mix to run");
+  return kept;
+}
+
+function percentile(sorted: number[], p: number) {
+  if (sorted.length === 0) return 0;
+  const rank = Math.ceil((p / 100) * sorted.length) - 1;
+  return sorted[Math.min(Math.max(rank, 0), sorted.length - 1)]!;
+}
+
+// --- Seeding -----------------------------------------------------------------
+
+const seedEmail = (i: number) => `user-${i}@${SEED_DOMAIN}`;
+const isSeededUnsubscribed = (i: number) => i % UNSUBSCRIBED_EVERY === 0;
+
+/**
+ * Bulk load through `wrangler d1 execute --file`, which runs literal SQL
+ * and so isn't bound by D1's 100-parameter limit. INSERT OR IGNORE makes
+ * reruns cheap; the count triggers only see rows that were inserted.
+ */
+async function seed(rows: number) {
+  const dir = await mkdtemp(join(tmpdir(), "ambio-bench-"));
+  const file = join(dir, "seed.sql");
+  const now = Math.floor(Date.now() / 1000);
+  const statements: string[] = [];
+
+  for (let start = 0; start < rows; start += SEED_ROWS_PER_STATEMENT) {
+    const values: string[] = [];
+    const end = Math.min(start + SEED_ROWS_PER_STATEMENT, rows);
+    for (let i = start; i < end; i++) {
+      const status = isSeededUnsubscribed(i) ? "unsubscribed" : "active";
+      // One signup every 30s, oldest first, so pages have a stable order
+      const createdAt = now - (rows - i) * 30;
+      values.push(
+        `('${seedEmail(i)}', '${status}', ${createdAt}, ${createdAt})`,
+      );
+    }
+    statements.push(
+      "INSERT OR IGNORE INTO subscriptions (email, status, created_at, updated_at) VALUES\n" +
+        values.join(",\n") +
+        ";",
+    );
+  }
+
+  await Bun.write(file, statements.join("\n"));
+  try {
+    console.log(`Seeding ${rows} subscriptions...`);
+    await wrangler(["d1", "execute", DATABASE, "--local", `--file=${file}`]);
+  } finally {
+    await rm(dir, { recursive: true, force: true });
+  }
+}
+
+// --- Server ------------------------------------------------------------------
+
+async function startServer() {
+  const proc = Bun.spawn(
+    [
+      "bun",
+      "run",
+      "wrangler",
+      "dev",
+      "--ip=127.0.0.1",
+      `--port=${options.port}`,
+      ...wranglerArgs,
+    ],
+    { stdout: "ignore", stderr: "inherit" },
+  );
+
+  // The HEAD warmup route answers without touching any binding
+  const deadline = Date.now() + 60_000;
+  while (Date.now() < deadline) {
+    if (proc.exitCode !== null) {
+      throw new Error(`wrangler dev exited with ${proc.exitCode}`);
+    }
+    try {
+      const response = await fetch(`${baseUrl}/api/subscribe`, {
+        method: "HEAD",
+      });
+      if (response.ok) return proc;
+    } catch {
+      // Not listening yet
+    }
+    await Bun.sleep(500);
+  }
+
+  proc.kill();
+  throw new Error("wrangler dev did not become ready within 60s");
+}
+
+// --- Scenarios ---------------------------------------------------------------
+
+interface Client {
+  signedUp: string[]; // Emails this client subscribed, for unsubscribe
+  cursor: string | null; // Position in the current cursor walk
+  pagesWalked: number;
+}
+
+type Scenario = (client: Client) => Promise<Response>;
+
+let signupCounter = 0;
+const runId = Date.now().toString(36);
+
+// A fresh address every request keeps the rate limiter out of the way
+function randomIp() {
+  return `10.${randomInt(256)}.${randomInt(256)}.${randomInt(256)}`;
+}
+
+function post(path: string, email: string, ip = randomIp()) {
+  return fetch(`${baseUrl}${path}`, {
+    method: "POST",
+    headers: {
+      "content-type": "application/json",
+      "cf-connecting-ip": ip,
+      "user-agent": "ambio-bench",
+    },
+    body: JSON.stringify({ email }),
+  });
+}
+
+function admin(query: Record<string, string>) {
+  const params = new URLSearchParams({ limit: String(pageSize), ...query });
+  return fetch(`${baseUrl}/api/admin/subscriptions?${params}`, {
+    headers: { authorization: `Bearer ${adminKey}` },
+  });
+}
+
+// Seeded rows that are still active, picked uniformly
+function seededActiveIndex() {
+  const i = randomInt(seedRows);
+  return isSeededUnsubscribed(i) ? i + 1 : i;
+}
+
+const scenarios: Record<string, Scenario> = {
+  // First-time signup
+  signup: (client) => {
+    const email = `user-${runId}-${signupCounter++}@${SIGNUP_DOMAIN}`;
+    client.signedUp.push(email);
+    return post("/api/subscribe", email);
+  },
+
+  // Already subscribed: upsert hits the conflict path
+  duplicate: () => post("/api/subscribe", seedEmail(seededActiveIndex())),
+
+  // Previously unsubscribed: rejected with 400
+  unsubscribed: () =>
+    post(
+      "/api/subscribe",
+      seedEmail(randomInt(seedRows / UNSUBSCRIBED_EVERY) * UNSUBSCRIBED_EVERY),
+    ),
+
+  // Every request from one address; all but the first few get 429
+  ratelimited: () =>
+    post("/api/subscribe", seedEmail(seededActiveIndex()), RATE_LIMITED_IP),
+
+  // Unsubscribe an address this client signed up, or an unknown one
+  unsubscribe: (client) =>
+    post(
+      "/api/unsubscribe",
+      client.signedUp.pop() ?? `missing-${randomInt(1e9)}@${SIGNUP_DOMAIN}`,
+    ),
+
+  // Walk the list by keyset cursor, pageDepth pages deep, then start over
+  "page-cursor": async (client) => {
+    const response = await admin(
+      client.cursor ? { cursor: client.cursor } : {},
+    );
+    const body = response.ok
+      ? ((await response.clone().json()) as {
+          pagination?: { nextCursor?: string | null };
+        })
+      : undefined;
+    const next = body?.pagination?.nextCursor ?? null;
+
+    client.pagesWalked++;
+    if (!next || client.pagesWalked >= pageDepth) {
+      client.cursor = null;
+      client.pagesWalked = 0;
+    } else {
+      client.cursor = next;
+    }
+    return response;
+  },
+
+  // Random deep OFFSET page, for comparison with the cursor walk
+  "page-offset": () =>
+    admin({ offset: String(randomInt(Math.max(seedRows - pageSize, 1))) }),
+};
+
+// --- Run ---------------------------------------------------------------------
+
+interface ScenarioStats {
+  latencies: number[];
+  statuses: Map<number, number>; // 0 = network error
+}
+
+async function run(mix: [string, number][]) {
+  const totalWeight = mix.reduce((sum, [, weight]) => sum + weight, 0);
+  const pick = () => {
+    let roll = random() * totalWeight;
+    for (const [name, weight] of mix) {
+      if ((roll -= weight) < 0) return name;
+    }
+    return mix[mix.length - 1]![0];
+  };
+
+  const stats = new Map<string, ScenarioStats>(
+    mix.map(([name]) => [name, { latencies: [], statuses: new Map() }]),
+  );
+
+  const startedAt = performance.now();
+  const deadline = startedAt + durationMs;
+
+  const worker = async () => {
+    const client: Client = { signedUp: [], cursor: null, pagesWalked: 0 };
+    while (performance.now() < deadline) {
+      const name = pick();
+      const entry = stats.get(name)!;
+      const start = performance.now();
+      let status = 0;
+      try {
+        const response = await scenarios[name]!(client);
+        status = response.status;
+        await response.arrayBuffer();
+      } catch {
+        // Counted as status 0
+      }
+      entry.latencies.push(performance.now() - start);
+      entry.statuses.set(status, (entry.statuses.get(status) ?? 0) + 1);
+    }
+  };
+
+  await Promise.all(Array.from({ length: concurrency }, worker));
+  return { stats, elapsedMs: performance.now() - startedAt };
+}
+
+function report(stats: Map<string, ScenarioStats>, elapsedMs: number) {
+  const seconds = elapsedMs / 1000;
+  const summarize = (name: string, latencies: number[], statuses: string) => {
+    const sorted = [...latencies].sort((a, b) => a - b);
+    return {
+      scenario: name,
+      requests: sorted.length,
+      rps: Number((sorted.length / seconds).toFixed(1)),
+      p50: Number(percentile(sorted, 50).toFixed(1)),
+      p95: Number(percentile(sorted, 95).toFixed(1)),
+      p99: Number(percentile(sorted, 99).toFixed(1)),
+      max: Number((sorted[sorted.length - 1] ?? 0).toFixed(1)),
+      statuses,
+    };
+  };
+
+  const rows = [...stats].map(([name, { latencies, statuses }]) =>
+    summarize(
+      name,
+      latencies,
+      [...statuses]
+        .sort(([a], [b]) => a - b)
+        .map(([status, count]) => `${status}:${count}`)
+        .join(" "),
+    ),
+  );
+  rows.push(
+    summarize(
+      "total",
+      [...stats.values()].flatMap(({ latencies }) => latencies),
+      "",
+    ),
+  );
+
+  if (options.json) {
+    console.log(JSON.stringify({ durationMs: elapsedMs, concurrency, rows }));
+    return;
+  }
+
+  console.log(
+    `\n${options.mix} mix, ${concurrency} clients, ${seconds.toFixed(1)}s (latency in ms)\n`,
+  );
+  console.table(rows);
+}
+
+async function main() {
+  const mix = parseMix(options.mix);
+
+  await wrangler(["d1", "migrations", "apply", DATABASE, "--local"]);
+  if (!options["no-seed"] && seedRows > 0) {
+    await seed(seedRows);
+  }
+  if (adminKey) {
+    await wrangler([
+      "secrets-store",
+      "secret",
+      "create",
+      SECRET_STORE_ID,
+      `--name=${SECRET_NAME}`,
+      `--value=${adminKey}`,
+      "--scopes=workers",
+    ]).catch((error) => {
+      // Already created by an earlier run
+      console.warn(`Could not create the local admin key: ${error.message}`);
+    });
+  }
+
+  const server = await startServer();
+  try {
+    console.log(
+      `Running ${options.mix} mix for ${options.duration}s with ${concurrency} clients...`,
+    );
+    const { stats, elapsedMs } = await run(mix);
+    report(stats, elapsedMs);
+  } finally {
+    server.kill();
+    await server.exited;
+  }
+}
+
+await main();
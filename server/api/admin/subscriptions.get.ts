@@ -1,7 +1,54 @@
 import { desc, eq, sql } from "drizzle-orm";
-import { subscriptions } from "../../database/schema";
+import { subscriptionCounts, subscriptions } from "../../database/schema";
+import {
+  setCSVAttachmentHeaders,
+  SUBSCRIPTION_CSV_HEADERS,
+  subscriptionToCSVRow,
+} from "../../utils/csv";
+import { timed } from "../../utils/analytics";
 import { useDB } from "../../utils/db";
 import { requireAdminAuth } from "../../utils/auth";
+import {
+  decodeCursor,
+  encodeCursor,
+  subscriptionFilter,
+} from "../../utils/pagination";
+
+// Columns selectable with `fields=`; the whole row is only a few columns
+// now that request metadata lives in subscription_events
+const SUBSCRIPTION_COLUMNS = {
+  id: subscriptions.id,
+  email: subscriptions.email,
+  status: subscriptions.status,
+  createdAt: subscriptions.createdAt,
+  updatedAt: subscriptions.updatedAt,
+};
+
+type SubscriptionField = keyof typeof SUBSCRIPTION_COLUMNS;
+
+/**
+ * Projection for `fields=email,status`. `id` and `createdAt` are always
+ * included because they key the cursor. Returns null for unknown fields.
+ */
+function selectColumns(fields: string | undefined) {
+  if (!fields) return SUBSCRIPTION_COLUMNS;
+
+  const names = new Set<string>(["id", "createdAt"]);
+  for (const name of fields.split(",")) {
+    const field = name.trim();
+    if (!Object.hasOwn(SUBSCRIPTION_COLUMNS, field)) return null;
+    names.add(field);
+  }
+
+  // Typed as the full set: rows keep the shape the cursor helpers expect,
+  // and JSON output simply omits the unselected keys
+  return Object.fromEntries(
+    [...names].map((name) => [
+      name,
+      SUBSCRIPTION_COLUMNS[name as SubscriptionField],
+    ]),
+  ) as typeof SUBSCRIPTION_COLUMNS;
+}
 
 export default defineEventHandler(async (event) => {
   // Validate API key from Secrets Store
@@ -12,93 +59,71 @@ export default defineEventHandler(async (event) => {
 
   const format = (query.format as string) || "json";
   const limit = Math.min(Number(query.limit) || 100, 1000); // Cap at 1000
-  const offset = Number(query.offset) || 0;
   const status = query.status as "active" | "unsubscribed" | undefined;
 
-  // Build query with optional status filter
-  let results;
-  if (status) {
-    results = await db
-      .select()
-      .from(subscriptions)
-      .where(eq(subscriptions.status, status))
-      .orderBy(desc(subscriptions.createdAt))
-      .limit(limit)
-      .offset(offset);
-  } else {
-    results = await db
-      .select()
-      .from(subscriptions)
-      .orderBy(desc(subscriptions.createdAt))
-      .limit(limit)
-      .offset(offset);
+  // CSV always carries every column
+  const columns =
+    format === "csv"
+      ? SUBSCRIPTION_COLUMNS
+      : selectColumns(query.fields as string | undefined);
+  if (!columns) {
+    throw createError({ statusCode: 400, message: "Invalid fields" });
   }
 
-  // Get total count (with same filter if applicable)
-  let countResult;
-  if (status) {
-    countResult = await db
-      .select({ count: sql<number>`count(*)` })
-      .from(subscriptions)
-      .where(eq(subscriptions.status, status));
-  } else {
-    countResult = await db
-      .select({ count: sql<number>`count(*)` })
-      .from(subscriptions);
+  // Keyset pagination: `cursor` (from a previous `nextCursor`) seeks past the
+  // last row seen, served by subscriptions_status_created_at_idx.
+  // Takes precedence over `offset`, which is kept for compatibility.
+  const cursorParam = query.cursor as string | undefined;
+  const cursor = cursorParam ? decodeCursor(cursorParam) : null;
+  if (cursorParam && !cursor) {
+    throw createError({ statusCode: 400, message: "Invalid cursor" });
   }
+  const offset = cursor ? 0 : Number(query.offset) || 0;
+
+  // Total comes from the trigger-maintained subscription_counts table in O(1).
+  // `exactCount=1` forces a real count(*) over subscriptions instead.
+  const exactCount = query.exactCount === "1" || query.exactCount === "true";
+
+  // Fetch one extra row to learn whether another page follows
+  const listQuery = db
+    .select(columns)
+    .from(subscriptions)
+    .where(subscriptionFilter({ status, cursor }))
+    .orderBy(desc(subscriptions.createdAt), desc(subscriptions.id))
+    .limit(limit + 1)
+    .offset(offset);
+
+  const countQuery = exactCount
+    ? db
+        .select({ count: sql<number>`count(*)` })
+        .from(subscriptions)
+        .where(subscriptionFilter({ status }))
+    : db
+        .select({
+          count: sql<number>`coalesce(sum(${subscriptionCounts.count}), 0)`,
+        })
+        .from(subscriptionCounts)
+        .where(status ? eq(subscriptionCounts.status, status) : undefined);
+
+  // Both reads go to D1 together in a single round trip
+  const [rows, countResult] = await timed(event, "d1:list", () =>
+    db.batch([listQuery, countQuery]),
+  );
+
+  const hasMore = rows.length > limit;
+  const results = hasMore ? rows.slice(0, limit) : rows;
+  const lastRow = results[results.length - 1];
+  const nextCursor = hasMore && lastRow ? encodeCursor(lastRow) : null;
   const total = countResult[0]?.count ?? 0;
 
   // Return CSV format if requested
   if (format === "csv") {
-    const headers = [
-      "id",
-      "email",
-      "status",
-      "ip_address",
-      "user_agent",
-      "created_at",
-      "updated_at",
-    ];
-
-    const escapeCSV = (value: string | null | undefined): string => {
-      if (value === null || value === undefined) return "";
-      const str = String(value);
-      // Escape quotes and wrap in quotes if contains comma, quote, or newline
-      if (str.includes(",") || str.includes('"') || str.includes("\n")) {
-        return `"${str.replace(/"/g, '""')}"`;
-      }
-      return str;
-    };
-
     const csvRows = [
-      headers.join(","),
-      ...results.map((row) =>
-        [
-          row.id,
-          escapeCSV(row.email),
-          row.status,
-          escapeCSV(row.ipAddress),
-          escapeCSV(row.userAgent),
-          row.createdAt instanceof Date
-            ? row.createdAt.toISOString()
-            : row.createdAt
-              ? new Date(row.createdAt).toISOString()
-              : "",
-          row.updatedAt instanceof Date
-            ? row.updatedAt.toISOString()
-            : row.updatedAt
-              ? new Date(row.updatedAt).toISOString()
-              : "",
-        ].join(","),
-      ),
+      SUBSCRIPTION_CSV_HEADERS.join(","),
+      ...results.map(subscriptionToCSVRow),
     ];
 
-    setHeader(event, "Content-Type", "text/csv; charset=utf-8");
-    setHeader(
-      event,
-      "Content-Disposition",
-      `attachment; filename="subscriptions-${new Date().toISOString().split("T")[0]}.csv"`,
-    );
+    setCSVAttachmentHeaders(event, "subscriptions");
 
     return csvRows.join("\n");
   }
@@ -110,7 +135,8 @@ export default defineEventHandler(async (event) => {
       total,
       limit,
       offset,
-      hasMore: offset + results.length < total,
+      hasMore,
+      nextCursor,
     },
   };
 });
@@ -0,0 +1,82 @@
+import { desc } from "drizzle-orm";
+import { subscriptions } from "../../../database/schema";
+import {
+  setCSVAttachmentHeaders,
+  SUBSCRIPTION_CSV_HEADERS,
+  subscriptionToCSVRow,
+} from "../../../utils/csv";
+import { timed } from "../../../utils/analytics";
+import { useDB } from "../../../utils/db";
+import { requireAdminAuth } from "../../../utils/auth";
+import {
+  cursorFromRow,
+  subscriptionFilter,
+  type KeysetCursor,
+} from "../../../utils/pagination";
+
+// Rows fetched from D1 per pull; bounds memory regardless of list size
+// (rows are a few short columns, so a chunk is well under a megabyte)
+const EXPORT_CHUNK_SIZE = 5000;
+
+/**
+ * Full subscriber list as a streamed CSV download.
+ * Rows are pulled in keyset-paginated chunks only as fast as the client
+ * reads them, so memory use stays constant as the list grows. Each pull is
+ * an index seek on (created_at, id), or (status, created_at, id) when
+ * filtered, so the whole export reads every row once instead of re-sorting
+ * the table per chunk.
+ *
+ * Every pull is one D1 query, and D1 allows 1,000 queries per Worker
+ * invocation, so one export tops out at about 5 million rows
+ * (EXPORT_CHUNK_SIZE x 1,000). Past that the stream errors mid-file;
+ * larger lists need to be exported per status or paged with the list API.
+ */
+export default defineEventHandler(async (event) => {
+  // Validate API key from Secrets Store
+  await requireAdminAuth(event);
+
+  const db = useDB(event);
+  const query = getQuery(event);
+  const status = query.status as "active" | "unsubscribed" | undefined;
+
+  const encoder = new TextEncoder();
+  let cursor: KeysetCursor | null = null;
+
+  const stream = new ReadableStream<Uint8Array>({
+    start(controller) {
+      controller.enqueue(encoder.encode(SUBSCRIPTION_CSV_HEADERS.join(",")));
+    },
+
+    async pull(controller) {
+      try {
+        const rows = await timed(event, "d1:export", () =>
+          db
+            .select()
+            .from(subscriptions)
+            .where(subscriptionFilter({ status, cursor }))
+            .orderBy(desc(subscriptions.createdAt), desc(subscriptions.id))
+            .limit(EXPORT_CHUNK_SIZE),
+        );
+
+        const lastRow = rows[rows.length - 1];
+        if (lastRow) {
+          controller.enqueue(
+            encoder.encode(`\n${rows.map(subscriptionToCSVRow).join("\n")}`),
+          );
+          cursor = cursorFromRow(lastRow);
+        }
+
+        if (rows.length < EXPORT_CHUNK_SIZE) {
+          controller.close();
+        }
+      } catch (error) {
+        console.error("Subscription export failed:", error);
+        controller.error(error);
+      }
+    },
+  });
+
+  setCSVAttachmentHeaders(event, "subscriptions-export");
+
+  return stream;
+});
@@ -0,0 +1,88 @@
+import { timed } from "../../../utils/analytics";
+import { requireAdminAuth } from "../../../utils/auth";
+import { useDB } from "../../../utils/db";
+import {
+  createLineParser,
+  importChunk,
+  readLines,
+  type ImportChunkResult,
+  type ImportFormat,
+} from "../../../utils/import";
+
+// Input lines per INSERT; each chunk is a single D1 query
+const IMPORT_CHUNK_LINES = 1000;
+// Upper bound per request; larger files are split by the caller. At one
+// query per chunk this is 100 queries, well inside D1's 1,000 per invocation.
+const MAX_IMPORT_LINES = 100_000;
+
+/**
+ * Bulk import subscriptions from a streamed NDJSON or CSV body.
+ *
+ * The format comes from `?format=csv|ndjson`, else the Content-Type
+ * (anything mentioning csv is CSV, everything else NDJSON). Returns
+ * accepted/rejected counts per chunk of IMPORT_CHUNK_LINES lines plus
+ * totals; `truncated` is set when the body exceeded MAX_IMPORT_LINES and
+ * the rest was not read.
+ */
+export default defineEventHandler(async (event) => {
+  // Validate API key from Secrets Store
+  await requireAdminAuth(event);
+
+  const query = getQuery(event);
+  const contentType = getHeader(event, "content-type") ?? "";
+  const format: ImportFormat =
+    query.format === "csv" ||
+    (query.format !== "ndjson" && contentType.includes("csv"))
+      ? "csv"
+      : "ndjson";
+
+  const stream = getRequestWebStream(event);
+  if (!stream) {
+    throw createError({ statusCode: 400, message: "Request body is required" });
+  }
+
+  const db = useDB(event);
+  const parseLine = createLineParser(format);
+  const seen = new Set<string>();
+  const chunks: ImportChunkResult[] = [];
+  let pending: (string | null)[] = [];
+  let lines = 0;
+  let truncated = false;
+
+  const flush = async () => {
+    if (pending.length === 0) return;
+    const candidates = pending;
+    pending = [];
+    chunks.push(
+      await timed(event, "d1:import", () =>
+        importChunk(db, chunks.length, candidates, seen),
+      ),
+    );
+  };
+
+  for await (const line of readLines(stream)) {
+    if (!line.trim()) continue;
+    if (++lines > MAX_IMPORT_LINES) {
+      truncated = true;
+      break;
+    }
+
+    const candidate = parseLine(line);
+    if (candidate === undefined) continue; // CSV header
+    pending.push(candidate);
+    if (pending.length >= IMPORT_CHUNK_LINES) await flush();
+  }
+  await flush();
+
+  const total = chunks.reduce(
+    (sum, chunk) => ({
+      received: sum.received + chunk.received,
+      inserted: sum.inserted + chunk.inserted,
+      existing: sum.existing + chunk.existing,
+      rejected: sum.rejected + chunk.rejected,
+    }),
+    { received: 0, inserted: 0, existing: 0, rejected: 0 },
+  );
+
+  return { success: true, format, total, chunks, truncated };
+});
@@ -0,0 +1,79 @@
+import { isWebGLMetrics } from "#shared/utils/webglMetrics";
+import { LRUCache } from "../utils/lru";
+import { requireBodySize } from "../utils/validation";
+
+// A beacon carries one small JSON object
+const MAX_METRICS_BODY_BYTES = 2048;
+
+// A page sends at most one beacon per visit, so anything above this per IP
+// is dropped. Counted per isolate: it bounds what one client can write
+// through a warm isolate without a KV or rate limiter call per beacon.
+const MAX_BEACONS_PER_WINDOW = 10;
+const BEACON_WINDOW_MS = 60_000;
+
+const beaconCounts = new LRUCache<
+  string,
+  { windowStart: number; count: number }
+>(4096);
+
+function allowBeacon(ip: string, now: number): boolean {
+  const entry = beaconCounts.get(ip);
+  if (!entry || now - entry.windowStart >= BEACON_WINDOW_MS) {
+    beaconCounts.set(ip, { windowStart: now, count: 1 });
+    return true;
+  }
+  entry.count++;
+  return entry.count <= MAX_BEACONS_PER_WINDOW;
+}
+
+/**
+ * WebGL background metrics beacons (app/utils/webglMetricsReporter.ts),
+ * written to Analytics Engine as one data point each:
+ *   index1  "webgl"
+ *   blob1   "webgl", blob2 mode (bench | rum), blob3 antialiasing,
+ *   blob4   user agent
+ *   double1-7  frames, total frame time (ms), pixel ratio, particles drawn,
+ *              quality level, draw calls, points
+ *   double8+   frame-time histogram counts (FRAME_TIME_BUCKETS)
+ */
+export default defineEventHandler(async (event) => {
+  requireBodySize(event, MAX_METRICS_BODY_BYTES);
+
+  // Beacons ignore the response, so excess ones are dropped silently
+  const ip =
+    getHeader(event, "cf-connecting-ip") ||
+    getHeader(event, "x-forwarded-for") ||
+    "unknown";
+  if (!allowBeacon(ip, Date.now())) {
+    setResponseStatus(event, 204);
+    return null;
+  }
+
+  const metrics = await readBody<unknown>(event);
+  if (!isWebGLMetrics(metrics)) {
+    throw createError({ statusCode: 400, message: "Invalid metrics" });
+  }
+
+  event.context.cloudflare.env.ANALYTICS?.writeDataPoint({
+    indexes: ["webgl"],
+    blobs: [
+      "webgl",
+      metrics.mode,
+      metrics.antialias ? "antialias" : "no-antialias",
+      (getHeader(event, "user-agent") ?? "").slice(0, 256),
+    ],
+    doubles: [
+      metrics.frames,
+      metrics.frameTimeTotalMs,
+      metrics.pixelRatio,
+      metrics.particleCount,
+      metrics.qualityLevel,
+      metrics.drawCalls,
+      metrics.points,
+      ...metrics.frameTimeHistogram,
+    ],
+  });
+
+  setResponseStatus(event, 204);
+  return null;
+});
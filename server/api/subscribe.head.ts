@@ -0,0 +1,9 @@
+/**
+ * Connection warmup for the signup form: a bodyless request it sends when
+ * the email input gains focus, so TLS and the Worker isolate are ready by
+ * the time the user submits. Touches no bindings.
+ */
+export default defineEventHandler((event) => {
+  setResponseStatus(event, 204);
+  return null;
+});
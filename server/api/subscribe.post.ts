@@ -1,75 +1,85 @@
 import { eq } from "drizzle-orm";
 import { subscriptions } from "../database/schema";
+import { timed } from "../utils/analytics";
 import { useDB } from "../utils/db";
+import { insertActiveSubscriptionEvents } from "../utils/events";
+import { isQueueIngestEnabled } from "../utils/ingest";
 import { requireRateLimit } from "../utils/ratelimit";
+import { isKnownUnsubscribed, markUnsubscribed } from "../utils/unsubscribed";
+import { readEmailBody } from "../utils/validation";
+
+const unsubscribedError = {
+  statusCode: 400,
+  message:
+    "This email was previously unsubscribed. Please contact support to reactivate.",
+};
 
 export default defineEventHandler(async (event) => {
   // Rate limiting: 5 requests per 60 seconds per IP
   await requireRateLimit(event, { limit: 5, window: 60 });
 
-  const body = await readBody<{ email: string }>(event);
-
-  // Validation - check body exists first to avoid TypeError on null body
-  if (!body || !body.email) {
-    throw createError({ statusCode: 400, message: "Email is required" });
-  }
-
-  // More robust email validation
-  // This regex handles most valid email formats including internationalized domains
-  const emailRegex =
-    /^[a-zA-Z0-9.!#$%&'*+/=?^_`{|}~-]+@[a-zA-Z0-9](?:[a-zA-Z0-9-]{0,61}[a-zA-Z0-9])?(?:\.[a-zA-Z0-9](?:[a-zA-Z0-9-]{0,61}[a-zA-Z0-9])?)*$/;
-  if (!emailRegex.test(body.email)) {
-    throw createError({ statusCode: 400, message: "Invalid email format" });
-  }
-
-  const db = useDB(event);
+  const normalizedEmail = await readEmailBody(event);
 
   // Extract metadata
   const ipAddress =
     getHeader(event, "cf-connecting-ip") || getHeader(event, "x-forwarded-for");
   const userAgent = getHeader(event, "user-agent");
 
-  // Normalize email
-  const normalizedEmail = body.email.toLowerCase().trim();
-  const MAX_EMAIL_LENGTH = 254;
-  if (normalizedEmail.length > MAX_EMAIL_LENGTH) {
-    throw createError({ statusCode: 400, message: "Email is too long" });
-  }
+  const { env } = event.context.cloudflare;
+
+  // Write-behind mode: hand the signup to the queue consumer and return
+  // immediately. The row isn't read here, so unsubscribed emails are rejected
+  // from the unsubscribed set instead of the upsert result.
+  if (isQueueIngestEnabled(env)) {
+    const unsubscribed = await timed(event, "kv:unsubscribed", () =>
+      isKnownUnsubscribed(env, normalizedEmail),
+    );
+    if (unsubscribed) {
+      throw createError(unsubscribedError);
+    }
 
-  // Atomic upsert: insert new subscription or update metadata for existing active users.
-  // The ON CONFLICT clause only updates metadata, never the status field.
-  // This ensures unsubscribed users remain unsubscribed.
-  await db
-    .insert(subscriptions)
-    .values({
-      email: normalizedEmail,
-      ipAddress,
-      userAgent,
-    })
-    .onConflictDoUpdate({
-      target: subscriptions.email,
-      set: {
-        updatedAt: new Date(),
+    await timed(event, "queue:send", () =>
+      env.SUBSCRIPTION_QUEUE.send({
+        email: normalizedEmail,
         ipAddress,
         userAgent,
-      },
-    });
+        receivedAt: Date.now(),
+      }),
+    );
+
+    return { success: true, message: "Successfully subscribed" };
+  }
+
+  const db = useDB(event);
 
-  // Post-upsert verification: check if the email belongs to an unsubscribed user.
-  // This eliminates the TOCTOU race condition by checking AFTER the write completes.
-  // Even if concurrent requests occur, we correctly reject resubscription attempts.
-  const record = await db
-    .select({ status: subscriptions.status })
-    .from(subscriptions)
-    .where(eq(subscriptions.email, normalizedEmail))
-    .get();
+  // Insert new subscriptions; existing rows are left untouched, so a
+  // duplicate signup rewrites nothing and unsubscribed users remain
+  // unsubscribed.
+  //
+  // The event row and the status read run in the same batch (one round
+  // trip, one transaction), so both see the row as this insert left it and
+  // concurrent requests cannot interleave between them (no TOCTOU race).
+  // Request metadata is only appended for rows that are active, so rejected
+  // signups log nothing.
+  const [, , [record]] = await timed(event, "d1:upsert", () =>
+    db.batch([
+      db
+        .insert(subscriptions)
+        .values({ email: normalizedEmail })
+        .onConflictDoNothing({ target: subscriptions.email }),
+      insertActiveSubscriptionEvents(db, [
+        { email: normalizedEmail, type: "subscribe", ipAddress, userAgent },
+      ]),
+      db
+        .select({ status: subscriptions.status })
+        .from(subscriptions)
+        .where(eq(subscriptions.email, normalizedEmail)),
+    ]),
+  );
 
   if (record?.status === "unsubscribed") {
-    throw createError({
-      statusCode: 400,
-      message:
-        "This email was previously unsubscribed. Please contact support to reactivate.",
-    });
+    event.waitUntil(markUnsubscribed(env, normalizedEmail));
+    throw createError(unsubscribedError);
   }
 
   return { success: true, message: "Successfully subscribed" };
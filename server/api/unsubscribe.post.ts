@@ -1,46 +1,61 @@
-import { eq } from "drizzle-orm";
-import { subscriptions } from "../database/schema";
+import { timed } from "../utils/analytics";
 import { useDB } from "../utils/db";
+import { insertSubscriptionEvents } from "../utils/events";
+import { isQueueIngestEnabled } from "../utils/ingest";
 import { requireRateLimit } from "../utils/ratelimit";
+import { useStatements } from "../utils/statements";
+import { markUnsubscribed } from "../utils/unsubscribed";
+import { readEmailBody } from "../utils/validation";
 
 export default defineEventHandler(async (event) => {
   // Rate limiting: 5 requests per 60 seconds per IP
   await requireRateLimit(event, { limit: 5, window: 60 });
 
-  const body = await readBody<{ email: string }>(event);
-
-  // Validation - check body exists first to avoid TypeError on null body
-  if (!body || !body.email) {
-    throw createError({ statusCode: 400, message: "Email is required" });
+  const normalizedEmail = await readEmailBody(event);
+  const statements = useStatements(event);
+
+  // Soft delete - mark as unsubscribed. The status condition is part of the
+  // UPDATE, so missing and already-unsubscribed rows simply match nothing.
+  const updated = await timed(event, "d1:unsubscribe", () =>
+    statements.unsubscribeActiveByEmail.all({ email: normalizedEmail }),
+  );
+
+  const env = event.context.cloudflare.env;
+  const pending: Promise<unknown>[] = [];
+
+  // Keep subscribe-side caches from accepting this email again. With queue
+  // ingestion a signup may still be waiting in the queue with no row to
+  // update yet, so a short-lived marker is written even when nothing
+  // matched; it is what stops the consumer from inserting that signup as
+  // active, and it expires so a stray unsubscribe can't block the address.
+  if (updated.length > 0) {
+    pending.push(markUnsubscribed(env, normalizedEmail));
+  } else if (isQueueIngestEnabled(env)) {
+    pending.push(markUnsubscribed(env, normalizedEmail, { pending: true }));
   }
 
-  const db = useDB(event);
-  const normalizedEmail = body.email.toLowerCase().trim();
-
-  // Check if subscription exists
-  const existing = await db
-    .select()
-    .from(subscriptions)
-    .where(eq(subscriptions.email, normalizedEmail))
-    .get();
-
-  // Return generic success even if subscription doesn't exist (privacy)
-  if (!existing) {
-    return { success: true, message: "Successfully unsubscribed" };
+  // Log the request against the row it changed
+  if (updated.length > 0) {
+    const ipAddress =
+      getHeader(event, "cf-connecting-ip") ||
+      getHeader(event, "x-forwarded-for");
+    pending.push(
+      insertSubscriptionEvents(useDB(event), [
+        {
+          email: normalizedEmail,
+          type: "unsubscribe",
+          ipAddress,
+          userAgent: getHeader(event, "user-agent"),
+        },
+      ]),
+    );
   }
 
-  if (existing.status === "unsubscribed") {
-    return { success: true, message: "Successfully unsubscribed" };
+  // Neither needs to hold up the response
+  if (pending.length > 0) {
+    event.waitUntil(Promise.all(pending));
   }
 
-  // Soft delete - mark as unsubscribed
-  await db
-    .update(subscriptions)
-    .set({
-      status: "unsubscribed",
-      updatedAt: new Date(),
-    })
-    .where(eq(subscriptions.email, normalizedEmail));
-
+  // Return generic success whether or not a subscription existed (privacy)
   return { success: true, message: "Successfully unsubscribed" };
 });
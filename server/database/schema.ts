@@ -2,6 +2,7 @@ import {
   sqliteTable,
   text,
   integer,
+  index,
   uniqueIndex,
 } from "drizzle-orm/sqlite-core";
 
@@ -13,8 +14,6 @@ export const subscriptions = sqliteTable(
     status: text("status", { enum: ["active", "unsubscribed"] })
       .notNull()
       .default("active"),
-    ipAddress: text("ip_address"),
-    userAgent: text("user_agent"),
     createdAt: integer("created_at", { mode: "timestamp" })
       .notNull()
       .$defaultFn(() => new Date()),
@@ -22,8 +21,57 @@ export const subscriptions = sqliteTable(
       .notNull()
       .$defaultFn(() => new Date()),
   },
-  (table) => [uniqueIndex("subscriptions_email_idx").on(table.email)],
+  (table) => [
+    uniqueIndex("subscriptions_email_idx").on(table.email),
+    // Keyset pagination for the admin list and export: the unfiltered list
+    // walks (created_at, id) in order instead of scanning and sorting
+    index("subscriptions_created_at_idx").on(table.createdAt, table.id),
+    // ...and (created_at, id) seeks within a status
+    index("subscriptions_status_created_at_idx").on(
+      table.status,
+      table.createdAt,
+      table.id,
+    ),
+  ],
+);
+
+/**
+ * Append-only request metadata (IP, user agent) for each signup or
+ * unsubscribe. Kept out of `subscriptions` so the hot row and its indexes
+ * stay small and upserts for existing emails don't rewrite long strings.
+ */
+export const subscriptionEvents = sqliteTable(
+  "subscription_events",
+  {
+    id: integer("id").primaryKey({ autoIncrement: true }),
+    subscriptionId: integer("subscription_id")
+      .notNull()
+      .references(() => subscriptions.id, { onDelete: "cascade" }),
+    type: text("type", { enum: ["subscribe", "unsubscribe"] }).notNull(),
+    ipAddress: text("ip_address"),
+    userAgent: text("user_agent"),
+    createdAt: integer("created_at", { mode: "timestamp" })
+      .notNull()
+      .$defaultFn(() => new Date()),
+  },
+  (table) => [
+    index("subscription_events_subscription_created_at_idx").on(
+      table.subscriptionId,
+      table.createdAt,
+    ),
+  ],
 );
 
+/**
+ * Row count per subscription status, so totals can be read in O(1).
+ * Maintained by triggers on `subscriptions` (see migration 0004), which keeps
+ * it in step with every write path without application code.
+ */
+export const subscriptionCounts = sqliteTable("subscription_counts", {
+  status: text("status", { enum: ["active", "unsubscribed"] }).primaryKey(),
+  count: integer("count").notNull().default(0),
+});
+
 export type Subscription = typeof subscriptions.$inferSelect;
 export type NewSubscription = typeof subscriptions.$inferInsert;
+export type SubscriptionEvent = typeof subscriptionEvents.$inferSelect;
@@ -0,0 +1,32 @@
+import {
+  endpointTag,
+  startRequestTimings,
+  writeRequestTimings,
+} from "../utils/analytics";
+
+/**
+ * Hot-path instrumentation for the API: starts a timings record for every
+ * /api request and writes it to Analytics Engine when the request finishes,
+ * successfully or not. Handlers mark their stages with `timed()`.
+ */
+export default defineNitroPlugin((nitroApp) => {
+  nitroApp.hooks.hook("request", (event) => {
+    const { pathname } = getRequestURL(event);
+    if (pathname.startsWith("/api/")) {
+      startRequestTimings(event, endpointTag(event.method, pathname));
+    }
+  });
+
+  nitroApp.hooks.hook("afterResponse", (event) => {
+    writeRequestTimings(event, getResponseStatus(event));
+  });
+
+  nitroApp.hooks.hook("error", (error, { event }) => {
+    if (!event) return;
+    const status =
+      "statusCode" in error && typeof error.statusCode === "number"
+        ? error.statusCode
+        : 500;
+    writeRequestTimings(event, status);
+  });
+});
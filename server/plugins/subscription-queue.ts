@@ -0,0 +1,29 @@
+import {
+  ingestSignups,
+  SUBSCRIPTION_QUEUE_NAME,
+  type SubscriptionSignup,
+} from "../utils/ingest";
+
+/**
+ * Queue consumer for write-behind subscription ingestion.
+ * Drains signups enqueued by /api/subscribe into D1 in batches.
+ */
+export default defineNitroPlugin((nitroApp) => {
+  nitroApp.hooks.hook("cloudflare:queue", async ({ batch, env }) => {
+    if (batch.queue !== SUBSCRIPTION_QUEUE_NAME) return;
+
+    const messages = batch.messages as Message<SubscriptionSignup>[];
+
+    try {
+      await ingestSignups(
+        env as Env,
+        messages.map((message) => message.body),
+      );
+      batch.ackAll();
+    } catch (error) {
+      // The whole batch is written in one transaction, so retry it as a unit
+      console.error("Subscription ingestion failed:", error);
+      batch.retryAll();
+    }
+  });
+});
@@ -0,0 +1,89 @@
+/**
+ * Resized and re-encoded images for the @nuxt/image provider in
+ * app/providers/cloudflareImages.ts, produced by the IMAGES binding from
+ * the originals in public/images and kept in the edge Cache API.
+ *
+ *   /_img/images/logotype-dark.avif?w=348&q=80&f=avif
+ *
+ * Widths and qualities are snapped so arbitrary values can't fan out into
+ * unbounded transform work and cache entries.
+ */
+
+const OUTPUT_FORMATS = {
+  avif: "image/avif",
+  webp: "image/webp",
+  jpeg: "image/jpeg",
+  png: "image/png",
+} as const;
+
+type OutputFormat = keyof typeof OUTPUT_FORMATS;
+
+// Only files under public/images can be transformed
+const SOURCE_PREFIX = "images/";
+const MAX_WIDTH = 2048;
+const WIDTH_STEP = 16;
+const DEFAULT_QUALITY = 80;
+
+// Sources aren't content-hashed, so this is a week rather than immutable
+const CACHE_CONTROL = "public, max-age=604800, stale-while-revalidate=86400";
+
+function snapWidth(value: unknown): number | undefined {
+  const width = Number(value);
+  if (!Number.isFinite(width) || width <= 0) return undefined;
+  return Math.min(Math.ceil(width / WIDTH_STEP) * WIDTH_STEP, MAX_WIDTH);
+}
+
+function snapQuality(value: unknown): number {
+  const quality = Number(value);
+  if (!Number.isFinite(quality)) return DEFAULT_QUALITY;
+  return Math.min(Math.max(Math.round(quality / 5) * 5, 5), 100);
+}
+
+export default defineEventHandler(async (event) => {
+  const path = getRouterParam(event, "path") ?? "";
+  if (!path.startsWith(SOURCE_PREFIX) || path.includes("..")) {
+    throw createError({ statusCode: 404, message: "Image not found" });
+  }
+
+  const { env } = event.context.cloudflare ?? {};
+  const origin = getRequestURL(event).origin;
+
+  // Without the bindings (e.g. `nuxt dev`), serve the original
+  if (!env?.IMAGES || !env.ASSETS) {
+    return sendRedirect(event, `/${path}`, 302);
+  }
+
+  const query = getQuery(event);
+  const width = snapWidth(query.w);
+  const quality = snapQuality(query.q);
+  const format: OutputFormat =
+    typeof query.f === "string" && Object.hasOwn(OUTPUT_FORMATS, query.f)
+      ? (query.f as OutputFormat)
+      : "avif";
+
+  // Normalized key, so equivalent requests share one cache entry
+  const cacheKey = new Request(
+    `${origin}/_img/${path}?w=${width ?? ""}&q=${quality}&f=${format}`,
+  );
+  const cache = caches.default;
+  const cached = await cache.match(cacheKey);
+  if (cached) return cached;
+
+  const source = await env.ASSETS.fetch(new URL(`/${path}`, origin));
+  if (!source.ok || !source.body) {
+    throw createError({ statusCode: 404, message: "Image not found" });
+  }
+
+  const result = await env.IMAGES.input(source.body)
+    .transform(width ? { width, fit: "scale-down" } : {})
+    .output({ format: OUTPUT_FORMATS[format], quality });
+
+  const response = new Response(result.image(), {
+    headers: {
+      "content-type": result.contentType(),
+      "cache-control": CACHE_CONTROL,
+    },
+  });
+  event.waitUntil(cache.put(cacheKey, response.clone()));
+  return response;
+});
@@ -0,0 +1,114 @@
+import type { H3Event } from "h3";
+
+/**
+ * Per-stage request timings, written to the ANALYTICS Analytics Engine
+ * dataset once the response is done (see server/plugins/analytics.ts).
+ *
+ * Each stage becomes one data point:
+ *   index1  endpoint ("POST /api/subscribe"; "other" outside ENDPOINTS)
+ *   blob1   endpoint, blob2 stage, blob3 response status
+ *   double1 duration in ms
+ * plus a "total" stage covering the whole request, so percentiles can be
+ * compared per stage with `GROUP BY blob2`.
+ *
+ * Workers clocks only advance across I/O, which is exactly what the stages
+ * measure (KV, D1, Secrets Store, body reads).
+ */
+
+export interface RequestTimings {
+  endpoint: string;
+  startedAt: number;
+  stages: [stage: string, ms: number][];
+}
+
+declare module "h3" {
+  interface H3EventContext {
+    timings?: RequestTimings;
+  }
+}
+
+/**
+ * Endpoints tagged by name. Anything else under /api (probes, typos, wrong
+ * methods) shares one "other" tag, so arbitrary paths can't create new
+ * index values or exceed the 96-byte index limit.
+ */
+const ENDPOINTS = new Set([
+  "GET /api/admin/subscriptions",
+  "GET /api/admin/subscriptions/export",
+  "POST /api/admin/subscriptions/import",
+  "POST /api/metrics",
+  "HEAD /api/subscribe",
+  "POST /api/subscribe",
+  "POST /api/unsubscribe",
+]);
+
+export function endpointTag(method: string, pathname: string): string {
+  const endpoint = `${method} ${pathname}`;
+  return ENDPOINTS.has(endpoint) ? endpoint : "other";
+}
+
+export function startRequestTimings(event: H3Event, endpoint: string) {
+  event.context.timings = {
+    endpoint,
+    startedAt: performance.now(),
+    stages: [],
+  };
+}
+
+/**
+ * Run one stage of the request and record how long it took. Stages are
+ * recorded even when they throw. Without active timings (e.g. outside
+ * /api) this just runs the stage.
+ */
+export async function timed<T>(
+  event: H3Event,
+  stage: string,
+  run: () => Promise<T>,
+): Promise<T> {
+  if (!event.context.timings) return run();
+
+  const start = performance.now();
+  try {
+    return await run();
+  } finally {
+    recordStage(event, stage, performance.now() - start);
+  }
+}
+
+/**
+ * Record a stage that was measured (or skipped) without `timed`, e.g. a
+ * cache hit counted as a zero-length stage.
+ */
+export function recordStage(event: H3Event, stage: string, ms: number) {
+  event.context.timings?.stages.push([stage, ms]);
+}
+
+/**
+ * Flush the request's timings. Runs at most once per request; the write
+ * itself is buffered by the runtime and never delays the response.
+ */
+export function writeRequestTimings(event: H3Event, status: number) {
+  const timings = event.context.timings;
+  const dataset = event.context.cloudflare?.env.ANALYTICS;
+  event.context.timings = undefined;
+  if (!timings || !dataset) return;
+
+  const { endpoint } = timings;
+  const points: [string, number][] = [
+    ...timings.stages,
+    ["total", performance.now() - timings.startedAt],
+  ];
+
+  try {
+    for (const [stage, ms] of points) {
+      dataset.writeDataPoint({
+        indexes: [endpoint],
+        blobs: [endpoint, stage, String(status)],
+        doubles: [ms],
+      });
+    }
+  } catch (error) {
+    // Instrumentation must never fail a request
+    console.error("Analytics write failed:", error);
+  }
+}
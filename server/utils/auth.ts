@@ -1,9 +1,34 @@
 import type { H3Event } from "h3";
 import { timingSafeEqual } from "node:crypto";
+import { timed } from "./analytics";
 
-export async function validateAdminApiKey(event: H3Event): Promise<boolean> {
-  const { cloudflare } = event.context;
+// How long a Secrets Store lookup is reused by this isolate, so rotating the
+// key takes effect within this many milliseconds
+const ADMIN_KEY_TTL_MS = 60_000;
+
+let cachedAdminKey: { buffer: Buffer; expiresAt: number } | null = null;
+
+async function getAdminKeyBuffer(event: H3Event): Promise<Buffer | null> {
+  const now = Date.now();
+  if (cachedAdminKey && now < cachedAdminKey.expiresAt) {
+    return cachedAdminKey.buffer;
+  }
+
+  // Secrets Store requires async .get() call
+  const storedKey = await event.context.cloudflare.env.ADMIN_API_KEY.get();
+  if (!storedKey) {
+    cachedAdminKey = null;
+    return null;
+  }
 
+  cachedAdminKey = {
+    buffer: Buffer.from(storedKey, "utf-8"),
+    expiresAt: now + ADMIN_KEY_TTL_MS,
+  };
+  return cachedAdminKey.buffer;
+}
+
+export async function validateAdminApiKey(event: H3Event): Promise<boolean> {
   // Get API key from Authorization header
   const authHeader = getHeader(event, "authorization");
   if (!authHeader?.startsWith("Bearer ")) {
@@ -12,17 +37,18 @@ export async function validateAdminApiKey(event: H3Event): Promise<boolean> {
 
   const providedKey = authHeader.substring(7);
 
-  // Secrets Store requires async .get() call
-  const storedKey = await cloudflare.env.ADMIN_API_KEY.get();
+  if (!providedKey) {
+    return false;
+  }
 
-  if (!storedKey || !providedKey) {
+  const storedBuffer = await getAdminKeyBuffer(event);
+  if (!storedBuffer) {
     return false;
   }
 
   // timingSafeEqual requires buffers of equal length
   // If lengths differ, keys are definitely not equal, but we still
   // need to do a constant-time comparison to prevent timing attacks
-  const storedBuffer = Buffer.from(storedKey, "utf-8");
   const providedBuffer = Buffer.from(providedKey, "utf-8");
 
   if (storedBuffer.length !== providedBuffer.length) {
@@ -34,7 +60,7 @@ export async function validateAdminApiKey(event: H3Event): Promise<boolean> {
 }
 
 export async function requireAdminAuth(event: H3Event): Promise<void> {
-  const isValid = await validateAdminApiKey(event);
+  const isValid = await timed(event, "auth", () => validateAdminApiKey(event));
 
   if (!isValid) {
     throw createError({
@@ -0,0 +1,78 @@
+import type { H3Event } from "h3";
+import type { Subscription } from "../database/schema";
+
+export const SUBSCRIPTION_CSV_HEADERS = [
+  "id",
+  "email",
+  "status",
+  "created_at",
+  "updated_at",
+];
+
+export function escapeCSV(value: string | null | undefined): string {
+  if (value === null || value === undefined) return "";
+  const str = String(value);
+  // Escape quotes and wrap in quotes if contains comma, quote, or newline
+  if (str.includes(",") || str.includes('"') || str.includes("\n")) {
+    return `"${str.replace(/"/g, '""')}"`;
+  }
+  return str;
+}
+
+/**
+ * Split one CSV record into fields, undoing escapeCSV's quoting. Records
+ * are single lines; quoted newlines aren't supported.
+ */
+export function parseCSVLine(line: string): string[] {
+  const fields: string[] = [];
+  let field = "";
+  let quoted = false;
+
+  for (let i = 0; i < line.length; i++) {
+    const char = line[i];
+    if (quoted) {
+      if (char === '"' && line[i + 1] === '"') {
+        field += '"';
+        i++;
+      } else if (char === '"') {
+        quoted = false;
+      } else {
+        field += char;
+      }
+    } else if (char === '"') {
+      quoted = true;
+    } else if (char === ",") {
+      fields.push(field);
+      field = "";
+    } else {
+      field += char;
+    }
+  }
+
+  fields.push(field);
+  return fields;
+}
+
+function formatTimestamp(value: Date | number | null | undefined): string {
+  if (value instanceof Date) return value.toISOString();
+  return value ? new Date(value).toISOString() : "";
+}
+
+export function subscriptionToCSVRow(row: Subscription): string {
+  return [
+    row.id,
+    escapeCSV(row.email),
+    row.status,
+    formatTimestamp(row.createdAt),
+    formatTimestamp(row.updatedAt),
+  ].join(",");
+}
+
+export function setCSVAttachmentHeaders(event: H3Event, basename: string) {
+  setHeader(event, "Content-Type", "text/csv; charset=utf-8");
+  setHeader(
+    event,
+    "Content-Disposition",
+    `attachment; filename="${basename}-${new Date().toISOString().split("T")[0]}.csv"`,
+  );
+}
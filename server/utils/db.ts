@@ -1,8 +1,46 @@
-import { drizzle } from "drizzle-orm/d1";
+import { drizzle, type DrizzleD1Database } from "drizzle-orm/d1";
 import * as schema from "../database/schema";
 import type { H3Event } from "h3";
 
+/**
+ * D1 rejects statements with more than 100 bound parameters, which caps how
+ * many rows a single multi-row INSERT can carry.
+ */
+export const D1_MAX_BOUND_PARAMETERS = 100;
+
+export type Database = DrizzleD1Database<typeof schema>;
+
+// One client per D1 binding for the life of the isolate, so the schema
+// metadata is built once rather than on every request
+const clients = new WeakMap<D1Database, Database>();
+
 export function useDB(event: H3Event) {
   const { cloudflare } = event.context;
-  return drizzle(cloudflare.env.DB, { schema });
+  return createDB(cloudflare.env.DB);
+}
+
+/**
+ * Get the drizzle client for a raw D1 binding, for code that runs outside
+ * an H3 request (e.g. queue consumers).
+ */
+export function createDB(binding: D1Database): Database {
+  let db = clients.get(binding);
+  if (!db) {
+    db = drizzle(binding, { schema });
+    clients.set(binding, db);
+  }
+  return db;
+}
+
+/**
+ * Split rows into groups that fit in one statement, given how many bound
+ * parameters each row uses.
+ */
+export function chunkRows<T>(rows: T[], paramsPerRow: number): T[][] {
+  const size = Math.max(1, Math.floor(D1_MAX_BOUND_PARAMETERS / paramsPerRow));
+  const chunks: T[][] = [];
+  for (let i = 0; i < rows.length; i += size) {
+    chunks.push(rows.slice(i, i + size));
+  }
+  return chunks;
 }
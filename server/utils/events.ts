@@ -0,0 +1,77 @@
+import { sql } from "drizzle-orm";
+import { subscriptionEvents, subscriptions } from "../database/schema";
+import type { Database } from "./db";
+
+export interface SubscriptionEventInput {
+  email: string; // Normalized; resolved to the row id inside the statement
+  type: "subscribe" | "unsubscribe";
+  ipAddress?: string | null;
+  userAgent?: string | null;
+  createdAt?: Date;
+}
+
+// subscription_id (email lookup), type, ip_address, user_agent, created_at
+export const EVENT_PARAMS_PER_ROW = 5;
+
+// Resolves the id in SQL, so the event can share a batch with the upsert
+// that creates the row instead of waiting for its RETURNING
+function subscriptionIdByEmail(email: string) {
+  return sql<number>`(select ${subscriptions.id} from ${subscriptions} where ${subscriptions.email} = ${email})`;
+}
+
+/**
+ * Insert statement for subscription_events rows. Callers chunk by
+ * EVENT_PARAMS_PER_ROW and usually send it in the same db.batch() as the
+ * write it describes.
+ */
+export function insertSubscriptionEvents(
+  db: Database,
+  events: SubscriptionEventInput[],
+) {
+  return db.insert(subscriptionEvents).values(
+    events.map((event) => ({
+      subscriptionId: subscriptionIdByEmail(event.email),
+      type: event.type,
+      ipAddress: event.ipAddress ?? null,
+      userAgent: event.userAgent ?? null,
+      createdAt: event.createdAt ?? new Date(),
+    })),
+  );
+}
+
+/**
+ * Insert statement for events written only while the email's row is
+ * active, so signups rejected as unsubscribed log nothing. The events are
+ * bound as one JSON array and joined to their rows with INSERT ... SELECT:
+ * one statement for any number of events, and a failed guard inserts zero
+ * rows where the id subselect above would insert a NULL subscription_id.
+ */
+export function insertActiveSubscriptionEvents(
+  db: Database,
+  events: SubscriptionEventInput[],
+) {
+  const now = new Date();
+  const payload = events.map((event) => ({
+    email: event.email,
+    type: event.type,
+    ipAddress: event.ipAddress ?? null,
+    userAgent: event.userAgent ?? null,
+    // Seconds, as stored by the timestamp column
+    createdAt: Math.floor((event.createdAt ?? now).getTime() / 1000),
+  }));
+
+  return db.run(sql`
+    INSERT INTO subscription_events
+      (subscription_id, type, ip_address, user_agent, created_at)
+    SELECT
+      subscriptions.id,
+      json_extract(event.value, '$.type'),
+      json_extract(event.value, '$.ipAddress'),
+      json_extract(event.value, '$.userAgent'),
+      json_extract(event.value, '$.createdAt')
+    FROM json_each(${JSON.stringify(payload)}) AS event
+    JOIN subscriptions
+      ON subscriptions.email = json_extract(event.value, '$.email')
+    WHERE subscriptions.status = 'active'
+  `);
+}
@@ -0,0 +1,140 @@
+import { sql } from "drizzle-orm";
+import { isValidEmail, normalizeEmail } from "#shared/utils/email";
+import { parseCSVLine } from "./csv";
+import type { Database } from "./db";
+
+/**
+ * Bulk subscription import for the admin API: parses NDJSON or CSV bodies
+ * line by line and writes each chunk of input lines as a single
+ * INSERT ... SELECT FROM json_each(?) ... ON CONFLICT DO NOTHING.
+ *
+ * The chunk's emails are bound as one JSON array parameter, so a chunk is
+ * one D1 query however many rows it holds. Multi-row VALUES would stop at
+ * 25 rows per statement (100 bound parameters) and run into D1's limit of
+ * 1,000 queries per Worker invocation on large files.
+ *
+ * Existing rows are never modified, so unsubscribed addresses stay
+ * unsubscribed and active ones keep their original metadata.
+ */
+
+export type ImportFormat = "ndjson" | "csv";
+
+export interface ImportChunkResult {
+  chunk: number;
+  received: number; // Non-empty lines
+  inserted: number; // New subscriptions
+  existing: number; // Already present (any status) or repeated in the import
+  rejected: number; // Unparseable or invalid emails
+}
+
+/** Split a byte stream into lines without buffering the whole body. */
+export async function* readLines(
+  stream: ReadableStream<Uint8Array>,
+): AsyncGenerator<string> {
+  const reader = stream.pipeThrough(new TextDecoderStream()).getReader();
+  let buffer = "";
+
+  try {
+    while (true) {
+      const { done, value } = await reader.read();
+      if (done) break;
+      buffer += value;
+
+      let newline = buffer.indexOf("\n");
+      while (newline !== -1) {
+        yield buffer.slice(0, newline).replace(/\r$/, "");
+        buffer = buffer.slice(newline + 1);
+        newline = buffer.indexOf("\n");
+      }
+    }
+
+    if (buffer) yield buffer.replace(/\r$/, "");
+  } finally {
+    // Stops reading the body when the consumer bails out early
+    await reader.cancel();
+  }
+}
+
+/**
+ * Turns input lines into candidate emails. CSV takes the `email` column
+ * when the first line is a header naming one, otherwise the first column.
+ * NDJSON accepts `{"email": "..."}` objects or bare JSON strings.
+ */
+export function createLineParser(format: ImportFormat) {
+  let csvColumn: number | undefined;
+
+  return (line: string): string | null | undefined => {
+    if (format === "ndjson") {
+      try {
+        const value: unknown = JSON.parse(line);
+        if (typeof value === "string") return value;
+        if (typeof value === "object" && value !== null && "email" in value) {
+          return typeof value.email === "string" ? value.email : null;
+        }
+      } catch {
+        // Fall through to rejection
+      }
+      return null;
+    }
+
+    const fields = parseCSVLine(line);
+    if (csvColumn === undefined) {
+      const header = fields.findIndex(
+        (field) => field.trim().toLowerCase() === "email",
+      );
+      csvColumn = Math.max(header, 0);
+      // undefined marks a header line: skipped, not rejected
+      if (header !== -1) return undefined;
+    }
+    return fields[csvColumn] ?? null;
+  };
+}
+
+/**
+ * Validate and write one chunk of candidate emails. `seen` carries emails
+ * already handled earlier in the same import.
+ */
+export async function importChunk(
+  db: Database,
+  chunk: number,
+  candidates: (string | null)[],
+  seen: Set<string>,
+): Promise<ImportChunkResult> {
+  const result: ImportChunkResult = {
+    chunk,
+    received: candidates.length,
+    inserted: 0,
+    existing: 0,
+    rejected: 0,
+  };
+
+  const emails: string[] = [];
+  for (const candidate of candidates) {
+    const email = candidate === null ? "" : normalizeEmail(candidate);
+    if (!isValidEmail(email)) {
+      result.rejected++;
+    } else if (seen.has(email)) {
+      result.existing++;
+    } else {
+      seen.add(email);
+      emails.push(email);
+    }
+  }
+  if (emails.length === 0) return result;
+
+  // Seconds, as stored by the timestamp columns. `WHERE true` keeps SQLite
+  // from parsing ON CONFLICT as a join constraint of the SELECT.
+  const now = Math.floor(Date.now() / 1000);
+  const rows = await db.all<{ id: number }>(sql`
+    INSERT INTO subscriptions (email, status, created_at, updated_at)
+    SELECT value, 'active', ${now}, ${now} FROM json_each(${JSON.stringify(emails)})
+    WHERE true
+    ON CONFLICT (email) DO NOTHING
+    RETURNING id
+  `);
+  const inserted = rows.length;
+
+  result.inserted += inserted;
+  result.existing += emails.length - inserted;
+  return result;
+}
@@ -0,0 +1,115 @@
+import { sql } from "drizzle-orm";
+import { subscriptions } from "../database/schema";
+import { chunkRows, createDB } from "./db";
+import { insertActiveSubscriptionEvents } from "./events";
+import { isKnownUnsubscribed, markUnsubscribed } from "./unsubscribed";
+
+/**
+ * Queue used by the write-behind ingestion mode of /api/subscribe
+ * (SUBSCRIPTION_INGEST_MODE = "queue" in wrangler.jsonc).
+ */
+export const SUBSCRIPTION_QUEUE_NAME = "ambio-subscriptions";
+
+export interface SubscriptionSignup {
+  email: string; // Already validated and normalized
+  ipAddress?: string;
+  userAgent?: string;
+  receivedAt: number; // Epoch milliseconds
+}
+
+// email, status, created_at, updated_at
+const PARAMS_PER_ROW = 4;
+
+export function isQueueIngestEnabled(env: Env): boolean {
+  return env.SUBSCRIPTION_INGEST_MODE === "queue" && !!env.SUBSCRIPTION_QUEUE;
+}
+
+/**
+ * Write a batch of queued signups to D1 as multi-row upserts plus their
+ * subscription_events rows, sent together in a single db.batch() round trip.
+ *
+ * Conflicts never change status, so unsubscribed users remain unsubscribed.
+ * Unlike the synchronous path they do touch updated_at: the no-op update is
+ * what lets RETURNING report the status of every row in a chunk. Rows that
+ * come back unsubscribed are added to the unsubscribed set so later signups
+ * for them are rejected before being enqueued.
+ *
+ * Emails already in the unsubscribed set are dropped first. An unsubscribe
+ * that arrives while its signup is still queued finds no row to update, so
+ * the marker it leaves is the only record of it. The lookup bypasses the
+ * extended edge cache, but KV propagation still makes this best-effort: an
+ * unsubscribe that lands just before the batch can be missed, and the
+ * signup is then stored as active.
+ */
+export async function ingestSignups(
+  env: Env,
+  signups: SubscriptionSignup[],
+): Promise<void> {
+  // Collapse duplicates within the batch, keeping the latest metadata
+  const latest = new Map<string, SubscriptionSignup>();
+  for (const signup of signups) {
+    const previous = latest.get(signup.email);
+    if (!previous || previous.receivedAt <= signup.receivedAt) {
+      latest.set(signup.email, signup);
+    }
+  }
+
+  const pending = [...latest.values()];
+  const unsubscribed = await Promise.all(
+    pending.map((signup) =>
+      isKnownUnsubscribed(env, signup.email, { fresh: true }),
+    ),
+  );
+  const rows = pending.filter((_, i) => !unsubscribed[i]);
+  if (rows.length === 0) {
+    return;
+  }
+
+  const db = createDB(env.DB);
+
+  const upserts = chunkRows(rows, PARAMS_PER_ROW).map((chunk) =>
+    db
+      .insert(subscriptions)
+      .values(
+        chunk.map((signup) => ({
+          email: signup.email,
+          createdAt: new Date(signup.receivedAt),
+          updatedAt: new Date(signup.receivedAt),
+        })),
+      )
+      .onConflictDoUpdate({
+        target: subscriptions.email,
+        set: { updatedAt: sql`excluded.updated_at` },
+      })
+      .returning({
+        email: subscriptions.email,
+        status: subscriptions.status,
+      }),
+  );
+
+  // After the upserts in the batch, so every email resolves to a row id.
+  // Rows that are unsubscribed get no event, as on the synchronous path.
+  const events = insertActiveSubscriptionEvents(
+    db,
+    rows.map((signup) => ({
+      email: signup.email,
+      type: "subscribe",
+      ipAddress: signup.ipAddress,
+      userAgent: signup.userAgent,
+      createdAt: new Date(signup.receivedAt),
+    })),
+  );
+
+  const [first, ...rest] = upserts;
+  const results = await db.batch([first!, ...rest, events]);
+  const upserted = results.slice(0, upserts.length) as Awaited<
+    (typeof upserts)[number]
+  >[];
+
+  await Promise.all(
+    upserted
+      .flat()
+      .filter((row) => row.status === "unsubscribed")
+      .map((row) => markUnsubscribed(env, row.email)),
+  );
+}
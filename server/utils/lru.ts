@@ -0,0 +1,43 @@
+/**
+ * Small bounded LRU cache backed by Map insertion order.
+ *
+ * Instances are meant to live at module scope, so entries are shared by every
+ * request handled by the same isolate and disappear when the isolate is
+ * evicted. Never rely on them for correctness, only to skip work.
+ */
+export class LRUCache<K, V> {
+  private readonly entries = new Map<K, V>();
+
+  constructor(private readonly maxEntries: number) {}
+
+  get size(): number {
+    return this.entries.size;
+  }
+
+  get(key: K): V | undefined {
+    if (!this.entries.has(key)) {
+      return undefined;
+    }
+
+    // Re-insert to mark as most recently used
+    const value = this.entries.get(key) as V;
+    this.entries.delete(key);
+    this.entries.set(key, value);
+    return value;
+  }
+
+  set(key: K, value: V): void {
+    this.entries.delete(key);
+    this.entries.set(key, value);
+
+    // Evict the least recently used entry (first in insertion order)
+    if (this.entries.size > this.maxEntries) {
+      const oldest = this.entries.keys().next().value as K;
+      this.entries.delete(oldest);
+    }
+  }
+
+  delete(key: K): void {
+    this.entries.delete(key);
+  }
+}
@@ -0,0 +1,58 @@
+import { and, eq, sql } from "drizzle-orm";
+import { subscriptions } from "../database/schema";
+
+/**
+ * Opaque keyset cursor for lists ordered by (created_at DESC, id DESC).
+ * Encodes the position of the last row of a page so the next page can seek
+ * straight to it instead of scanning and discarding OFFSET rows.
+ */
+export interface KeysetCursor {
+  createdAt: number; // Unix timestamp in seconds, as stored in created_at
+  id: number;
+}
+
+export function cursorFromRow(row: {
+  createdAt: Date;
+  id: number;
+}): KeysetCursor {
+  return { createdAt: Math.floor(row.createdAt.getTime() / 1000), id: row.id };
+}
+
+export function encodeCursor(row: { createdAt: Date; id: number }): string {
+  const { createdAt, id } = cursorFromRow(row);
+  return Buffer.from(`${createdAt}:${id}`, "utf-8").toString("base64url");
+}
+
+export function decodeCursor(cursor: string): KeysetCursor | null {
+  const decoded = Buffer.from(cursor, "base64url").toString("utf-8");
+  const match = /^(\d+):(\d+)$/.exec(decoded);
+  if (!match) {
+    return null;
+  }
+  return { createdAt: Number(match[1]), id: Number(match[2]) };
+}
+
+/**
+ * Condition selecting subscriptions strictly after the cursor position.
+ * Row-value comparison lets SQLite seek the (created_at, id) index, or
+ * (status, created_at, id) when the list is filtered by status.
+ */
+export function afterCursor(cursor: KeysetCursor) {
+  return sql`(${subscriptions.createdAt}, ${subscriptions.id}) < (${cursor.createdAt}, ${cursor.id})`;
+}
+
+export interface SubscriptionFilters {
+  status?: "active" | "unsubscribed";
+  cursor?: KeysetCursor | null;
+}
+
+/**
+ * Single WHERE builder for subscription list queries, so list, count and
+ * export paths stay in step as filters are added.
+ */
+export function subscriptionFilter(filters: SubscriptionFilters) {
+  return and(
+    filters.status ? eq(subscriptions.status, filters.status) : undefined,
+    filters.cursor ? afterCursor(filters.cursor) : undefined,
+  );
+}
@@ -1,18 +1,53 @@
 import type { H3Event } from "h3";
+import { recordStage, timed } from "./analytics";
+import { LRUCache } from "./lru";
 
 interface RateLimitConfig {
   limit: number; // Number of requests allowed
   window: number; // Time window in seconds
 }
 
+interface RateLimitVerdict {
+  allowed: boolean;
+  resetAt: number; // Unix timestamp (seconds) when the current window ends
+}
+
+/**
+ * Policy enforced by the native `RATE_LIMITER` binding (see `ratelimits` in
+ * wrangler.jsonc). The binding's limit and period are fixed at deploy time,
+ * so it is only used when a caller asks for exactly this policy; any other
+ * config falls back to the KV limiter.
+ */
+const NATIVE_RATE_LIMIT: RateLimitConfig = { limit: 5, window: 60 };
+
+/**
+ * How long a native rejection is cached in the isolate, in seconds. The
+ * binding doesn't say when its window ends; caching for a whole window from
+ * the rejection could block a client for up to twice the period. A short
+ * hold still absorbs a burst while the binding decides the rest.
+ */
+const NATIVE_BLOCK_CACHE_SECONDS = 10;
+
+/**
+ * In-isolate L1 cache of "blocked until resetAt" verdicts, keyed like the
+ * backend counters. Once a client is over the limit, its follow-up requests
+ * are rejected here without another backend call until the window ends.
+ *
+ * Hits are recorded as a "ratelimit:cache" stage and backend checks as
+ * "ratelimit:native" or "ratelimit:kv", so the hit rate per endpoint can be
+ * read from the request timings in Analytics Engine.
+ */
+const blockedClients = new LRUCache<string, number>(1024);
+
 /**
- * Simple in-memory rate limiter for Cloudflare Workers
+ * Rate limiter for Cloudflare Workers
  * Uses Cloudflare's Request metadata for client identification
  *
- * For production, consider using Cloudflare's native rate limiting:
- * - Cloudflare Rate Limiting Rules (Dashboard)
- * - Cloudflare Workers Rate Limiting API
- * - Durable Objects for distributed rate limiting
+ * Backends, in order of preference:
+ * - Workers Rate Limiting binding: counters live in memory at the edge and
+ *   each check is a single atomic call, with no storage round trips
+ * - KV namespace: read-modify-write counter, eventually consistent, so
+ *   concurrent requests can slip past the limit
  */
 export async function checkRateLimit(
   event: H3Event,
@@ -30,22 +65,78 @@ export async function checkRateLimit(
     return true;
   }
 
-  // Use KV namespace for distributed rate limiting if available
-  // This requires setting up a KV namespace in wrangler.toml
-  const kv = cloudflare.env.RATE_LIMIT_KV;
+  const key = `ratelimit:${clientIp}`;
+  const now = Math.floor(Date.now() / 1000); // Current timestamp in seconds
+
+  const blockedUntil = blockedClients.get(key);
+  if (blockedUntil !== undefined) {
+    if (now <= blockedUntil) {
+      recordStage(event, "ratelimit:cache", 0);
+      return false;
+    }
+    blockedClients.delete(key);
+  }
 
-  if (!kv) {
-    // KV not configured, skip rate limiting
-    // In production, you should configure KV or use Cloudflare's native rate limiting
-    console.warn(
-      "Rate limiting KV namespace not configured. Skipping rate limit check.",
+  let verdict: RateLimitVerdict;
+
+  const limiter = cloudflare.env.RATE_LIMITER;
+  if (
+    limiter &&
+    config.limit === NATIVE_RATE_LIMIT.limit &&
+    config.window === NATIVE_RATE_LIMIT.window
+  ) {
+    verdict = await timed(event, "ratelimit:native", () =>
+      checkNativeRateLimit(limiter, key, now),
+    );
+  } else {
+    // Use KV namespace for distributed rate limiting if available
+    // This requires setting up a KV namespace in wrangler.jsonc
+    const kv = cloudflare.env.RATE_LIMIT_KV;
+
+    if (!kv) {
+      // KV not configured, skip rate limiting
+      // In production, you should configure KV or use Cloudflare's native rate limiting
+      console.warn(
+        "Rate limiting KV namespace not configured. Skipping rate limit check.",
+      );
+      return true;
+    }
+
+    verdict = await timed(event, "ratelimit:kv", () =>
+      checkKVRateLimit(kv, key, config, now),
     );
-    return true;
   }
 
-  const key = `ratelimit:${clientIp}`;
-  const now = Math.floor(Date.now() / 1000); // Current timestamp in seconds
+  if (!verdict.allowed) {
+    blockedClients.set(key, verdict.resetAt);
+  }
+
+  return verdict.allowed;
+}
+
+async function checkNativeRateLimit(
+  limiter: RateLimit,
+  key: string,
+  now: number,
+): Promise<RateLimitVerdict> {
+  const resetAt = now + NATIVE_BLOCK_CACHE_SECONDS;
+
+  try {
+    const { success } = await limiter.limit({ key });
+    return { allowed: success, resetAt };
+  } catch (error) {
+    // On error, allow the request (fail open)
+    console.error("Rate limit check failed:", error);
+    return { allowed: true, resetAt };
+  }
+}
 
+async function checkKVRateLimit(
+  kv: KVNamespace,
+  key: string,
+  config: RateLimitConfig,
+  now: number,
+): Promise<RateLimitVerdict> {
   try {
     // Get current rate limit data
     const data = await kv.get(key, { type: "json" });
@@ -57,17 +148,16 @@ export async function checkRateLimit(
     // Check if window has expired
     if (now > current.resetAt) {
       // Reset the counter
-      await kv.put(
-        key,
-        JSON.stringify({ count: 1, resetAt: now + config.window }),
-        { expirationTtl: config.window },
-      );
-      return true;
+      const resetAt = now + config.window;
+      await kv.put(key, JSON.stringify({ count: 1, resetAt }), {
+        expirationTtl: config.window,
+      });
+      return { allowed: true, resetAt };
     }
 
     // Check if limit exceeded
     if (current.count >= config.limit) {
-      return false;
+      return { allowed: false, resetAt: current.resetAt };
     }
 
     // Increment counter
@@ -78,11 +168,11 @@ export async function checkRateLimit(
       { expirationTtl: ttl > 0 ? ttl : config.window },
     );
 
-    return true;
+    return { allowed: true, resetAt: current.resetAt };
   } catch (error) {
     // On error, allow the request (fail open)
     console.error("Rate limit check failed:", error);
-    return true;
+    return { allowed: true, resetAt: now + config.window };
   }
 }
 
@@ -90,7 +180,9 @@ export async function requireRateLimit(
   event: H3Event,
   config: RateLimitConfig,
 ): Promise<void> {
-  const allowed = await checkRateLimit(event, config);
+  const allowed = await timed(event, "ratelimit", () =>
+    checkRateLimit(event, config),
+  );
 
   if (!allowed) {
     throw createError({
@@ -0,0 +1,45 @@
+import { and, eq, sql } from "drizzle-orm";
+import type { H3Event } from "h3";
+import { subscriptions } from "../database/schema";
+import { useDB, type Database } from "./db";
+
+/**
+ * Hot-path statements, prepared once per drizzle client and reused with
+ * placeholders so each request only binds values.
+ *
+ * Timestamps are set with unixepoch() in SQL rather than `new Date()`, since
+ * a JS value would be captured once at prepare time.
+ */
+function prepareStatements(db: Database) {
+  return {
+    // Flips only active rows, so one statement both checks and updates
+    unsubscribeActiveByEmail: db
+      .update(subscriptions)
+      .set({
+        status: "unsubscribed",
+        updatedAt: sql`(unixepoch())`,
+      })
+      .where(
+        and(
+          eq(subscriptions.email, sql.placeholder("email")),
+          eq(subscriptions.status, "active"),
+        ),
+      )
+      .returning({ id: subscriptions.id })
+      .prepare(),
+  };
+}
+
+type Statements = ReturnType<typeof prepareStatements>;
+
+const statements = new WeakMap<Database, Statements>();
+
+export function useStatements(event: H3Event): Statements {
+  const db = useDB(event);
+  let prepared = statements.get(db);
+  if (!prepared) {
+    prepared = prepareStatements(db);
+    statements.set(db, prepared);
+  }
+  return prepared;
+}
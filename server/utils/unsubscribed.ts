@@ -0,0 +1,116 @@
+import { LRUCache } from "./lru";
+
+/**
+ * Edge-side set of unsubscribed emails, used by ingestion paths that do not
+ * read the subscriptions row before accepting a signup (see the queue mode in
+ * subscribe.post.ts). D1 stays the source of truth; this only lets those paths
+ * reject known-unsubscribed addresses early.
+ *
+ * Entries are stored in the existing KV namespace under their own prefix, and
+ * positive lookups are also remembered per isolate. Rows that were already
+ * unsubscribed before queue mode was enabled are loaded with
+ * scripts/backfill-unsubscribed.ts.
+ *
+ * KV is eventually consistent (writes can take 60s or more to reach other
+ * locations), so the set is best-effort: a marker written moments ago may
+ * not be visible yet.
+ */
+export const UNSUBSCRIBED_KEY_PREFIX = "unsubscribed:";
+
+// KV edge cache TTL for lookups, in seconds (KV minimum is 60)
+const KV_CACHE_TTL = 300;
+
+// Marker value for rows unsubscribed in D1. Pending markers store their
+// expiry (epoch milliseconds) instead, since a KV hit may be served from
+// the edge cache after the key itself has expired.
+const PERMANENT_MARKER = "1";
+
+/**
+ * Lifetime of a marker for an email that has no row yet, in seconds. It
+ * only has to outlive signups already in the queue (5s batch timeout, 3
+ * retries) plus KV propagation. Anyone can POST an unsubscribe, so a
+ * permanent marker here would let them block any address for good.
+ */
+const PENDING_UNSUBSCRIBE_TTL = 600;
+
+// Email -> expiry of the marker in epoch ms (Infinity when permanent)
+const knownUnsubscribed = new LRUCache<string, number>(4096);
+
+/**
+ * `fresh` skips the extended edge cache TTL: cacheTtl caches misses too, so
+ * a lookup made at signup time could otherwise hide a marker written after
+ * it for KV_CACHE_TTL seconds.
+ */
+export async function isKnownUnsubscribed(
+  env: Env,
+  email: string,
+  { fresh = false }: { fresh?: boolean } = {},
+): Promise<boolean> {
+  const now = Date.now();
+  const cachedUntil = knownUnsubscribed.get(email);
+  if (cachedUntil !== undefined) {
+    if (now < cachedUntil) {
+      return true;
+    }
+    knownUnsubscribed.delete(email);
+  }
+
+  const kv = env.RATE_LIMIT_KV;
+  if (!kv) {
+    return false;
+  }
+
+  try {
+    const marker = await kv.get(
+      `${UNSUBSCRIBED_KEY_PREFIX}${email}`,
+      fresh ? undefined : { cacheTtl: KV_CACHE_TTL },
+    );
+    if (marker !== null) {
+      const expiresAt = marker === PERMANENT_MARKER ? Infinity : Number(marker);
+      if (now < expiresAt) {
+        knownUnsubscribed.set(email, expiresAt);
+        return true;
+      }
+    }
+  } catch (error) {
+    // On error, treat as unknown; D1 still never flips the status back
+    console.error("Unsubscribed lookup failed:", error);
+  }
+
+  return false;
+}
+
+/**
+ * Add an email to the set. `pending` marks an unsubscribe that matched no
+ * row: the marker expires after PENDING_UNSUBSCRIBE_TTL and never replaces
+ * an existing one.
+ */
+export async function markUnsubscribed(
+  env: Env,
+  email: string,
+  { pending = false }: { pending?: boolean } = {},
+): Promise<void> {
+  if (pending && (await isKnownUnsubscribed(env, email))) {
+    return;
+  }
+
+  const expiresAt = pending
+    ? Date.now() + PENDING_UNSUBSCRIBE_TTL * 1000
+    : Infinity;
+  knownUnsubscribed.set(email, expiresAt);
+
+  const kv = env.RATE_LIMIT_KV;
+  if (!kv) {
+    return;
+  }
+
+  try {
+    await kv.put(
+      `${UNSUBSCRIBED_KEY_PREFIX}${email}`,
+      pending ? String(expiresAt) : PERMANENT_MARKER,
+      pending ? { expirationTtl: PENDING_UNSUBSCRIBE_TTL } : undefined,
+    );
+  } catch (error) {
+    console.error("Failed to record unsubscribed email:", error);
+  }
+}
@@ -0,0 +1,59 @@
+import type { H3Event } from "h3";
+import { timed } from "./analytics";
+import {
+  isValidEmail,
+  MAX_EMAIL_LENGTH,
+  normalizeEmail,
+} from "#shared/utils/email";
+
+// The public email endpoints accept one short JSON field; anything larger
+// is junk and is rejected before the body is read
+export const MAX_EMAIL_BODY_BYTES = 1024;
+
+/**
+ * Reject a request body by its declared size, before reading any of it.
+ * Bodies without a Content-Length (chunked uploads) are refused outright,
+ * since their size can't be known up front.
+ */
+export function requireBodySize(event: H3Event, maxBytes: number) {
+  const header = getHeader(event, "content-length");
+  const length = header === undefined ? NaN : Number(header);
+
+  if (!Number.isInteger(length) || length < 0) {
+    throw createError({ statusCode: 411, message: "Content-Length required" });
+  }
+  if (length > maxBytes) {
+    throw createError({ statusCode: 413, message: "Request body too large" });
+  }
+}
+
+/**
+ * Read and validate the `{ email }` body shared by subscribe and
+ * unsubscribe. Checks run cheapest first: declared size, the length limit,
+ * then the single-pass validator. Returns the normalized email.
+ */
+export async function readEmailBody(event: H3Event): Promise<string> {
+  requireBodySize(event, MAX_EMAIL_BODY_BYTES);
+
+  const body = await timed(event, "body", () =>
+    readBody<{ email?: unknown }>(event),
+  );
+
+  // Validation - check body exists first to avoid TypeError on null body
+  if (!body || !body.email) {
+    throw createError({ statusCode: 400, message: "Email is required" });
+  }
+  if (typeof body.email !== "string") {
+    throw createError({ statusCode: 400, message: "Invalid email format" });
+  }
+
+  const email = normalizeEmail(body.email);
+  if (email.length > MAX_EMAIL_LENGTH) {
+    throw createError({ statusCode: 400, message: "Email is too long" });
+  }
+  if (!isValidEmail(email)) {
+    throw createError({ statusCode: 400, message: "Invalid email format" });
+  }
+
+  return email;
+}
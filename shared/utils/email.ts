@@ -0,0 +1,68 @@
+/**
+ * Email rules shared by the signup form and the API, so the client rejects
+ * exactly what the server would without a round trip.
+ */
+
+// RFC 5321 path limit
+export const MAX_EMAIL_LENGTH = 254;
+
+const DOT = 0x2e;
+const HYPHEN = 0x2d;
+const MAX_LABEL_LENGTH = 63;
+
+// ASCII characters allowed in the local part besides letters and digits
+const LOCAL_SYMBOLS = new Set(
+  Array.from(".!#$%&'*+/=?^_`{|}~-", (char) => char.charCodeAt(0)),
+);
+
+function isAlphanumeric(code: number) {
+  return (
+    (code >= 0x30 && code <= 0x39) || // 0-9
+    (code >= 0x41 && code <= 0x5a) || // A-Z
+    (code >= 0x61 && code <= 0x7a) // a-z
+  );
+}
+
+export function normalizeEmail(email: string): string {
+  return email.toLowerCase().trim();
+}
+
+/**
+ * Single pass over at most MAX_EMAIL_LENGTH characters, so the cost is
+ * bounded whatever the input. Accepts a non-empty local part of letters,
+ * digits and RFC 5322 atom symbols, then a domain of dot-separated labels
+ * (1-63 letters, digits or inner hyphens). Internationalized domains are
+ * accepted in their punycode form.
+ */
+export function isValidEmail(email: string): boolean {
+  if (email.length > MAX_EMAIL_LENGTH) return false;
+
+  const at = email.indexOf("@");
+  if (at < 1) return false;
+
+  for (let i = 0; i < at; i++) {
+    const code = email.charCodeAt(i);
+    if (!isAlphanumeric(code) && !LOCAL_SYMBOLS.has(code)) return false;
+  }
+
+  // The end of the string closes the last label like a dot would
+  let labelStart = at + 1;
+  for (let i = labelStart; i <= email.length; i++) {
+    const code = i < email.length ? email.charCodeAt(i) : DOT;
+    if (code === DOT) {
+      const length = i - labelStart;
+      if (length < 1 || length > MAX_LABEL_LENGTH) return false;
+      if (
+        email.charCodeAt(labelStart) === HYPHEN ||
+        email.charCodeAt(i - 1) === HYPHEN
+      ) {
+        return false;
+      }
+      labelStart = i + 1;
+    } else if (!isAlphanumeric(code) && code !== HYPHEN) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,56 @@
+/**
+ * Frame-time and renderer metrics for the WebGL background, collected in
+ * the browser (opt-in `?bench=webgl`, or a sampled share of visits) and
+ * stored in Analytics Engine by /api/metrics.
+ */
+
+// Upper bounds (ms) of the frame-time histogram buckets; one extra bucket
+// counts everything slower. 16.7 is a 60Hz frame, 33.3 is 30Hz.
+export const FRAME_TIME_BUCKETS = [8, 12, 16.7, 20, 25, 33.3, 50, 100];
+
+export type WebGLMetricsMode = "bench" | "rum";
+
+export interface WebGLMetrics {
+  mode: WebGLMetricsMode;
+  frames: number;
+  frameTimeTotalMs: number;
+  frameTimeHistogram: number[]; // FRAME_TIME_BUCKETS.length + 1 counts
+  pixelRatio: number; // Effective renderer pixel ratio
+  particleCount: number; // Particles currently drawn
+  qualityLevel: number; // Index into QUALITY_LEVELS, 0 = best
+  antialias: boolean;
+  drawCalls: number; // renderer.info.render of the last frame
+  points: number;
+}
+
+export function frameTimeBucket(frameMs: number): number {
+  const index = FRAME_TIME_BUCKETS.findIndex((bound) => frameMs <= bound);
+  return index === -1 ? FRAME_TIME_BUCKETS.length : index;
+}
+
+const isCount = (value: unknown): value is number =>
+  typeof value === "number" && Number.isFinite(value) && value >= 0;
+
+/** Shape check for beacons; anything else is dropped by the server. */
+export function isWebGLMetrics(value: unknown): value is WebGLMetrics {
+  if (typeof value !== "object" || value === null) return false;
+  const metrics = value as Record<string, unknown>;
+  const histogram = metrics.frameTimeHistogram;
+
+  return (
+    (metrics.mode === "bench" || metrics.mode === "rum") &&
+    typeof metrics.antialias === "boolean" &&
+    Array.isArray(histogram) &&
+    histogram.length === FRAME_TIME_BUCKETS.length + 1 &&
+    histogram.every(isCount) &&
+    [
+      metrics.frames,
+      metrics.frameTimeTotalMs,
+      metrics.pixelRatio,
+      metrics.particleCount,
+      metrics.qualityLevel,
+      metrics.drawCalls,
+      metrics.points,
+    ].every(isCount)
+  );
+}
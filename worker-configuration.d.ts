@@ -7,6 +7,8 @@ declare namespace Cloudflare {
   }
   interface Env {
     RATE_LIMIT_KV: KVNamespace;
+    RATE_LIMITER: RateLimit;
+    SUBSCRIPTION_QUEUE: Queue;
     DB: D1Database;
     ANALYTICS: AnalyticsEngineDataset;
     ADMIN_API_KEY: SecretsStoreSecret;
@@ -19,6 +21,7 @@ declare namespace Cloudflare {
     CLOUDFLARE_ACCOUNT_ID: string;
     CLOUDFLARE_D1_TOKEN: string;
     CLOUDFLARE_DATABASE_ID: string;
+    SUBSCRIPTION_INGEST_MODE: string;
   }
 }
 interface Env extends Cloudflare.Env {}
@@ -35,6 +38,7 @@ declare namespace NodeJS {
       | "CLOUDFLARE_ACCOUNT_ID"
       | "CLOUDFLARE_D1_TOKEN"
       | "CLOUDFLARE_DATABASE_ID"
+      | "SUBSCRIPTION_INGEST_MODE"
     >
   > {}
 }